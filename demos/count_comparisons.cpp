@@ -1,6 +1,7 @@
 
 #define QUICKSORT_COUNT_COMPARISONS
 #include "include/algorithms.hpp"
+#include "include/integer_loader.hpp"
 
 #include <vector>
 #include <numeric>
@@ -17,21 +18,7 @@ long unsigned int solve(std::string filename, my::internal::AlgoConfig::Quicksor
 {
     my::n_comparisons = 0;
 
-    std::vector<datatype> data;
-    data.reserve(100'000);
-
-    auto file = std::ifstream(filename);
-
-    if (file.bad()) {
-        std::cerr << "Failed to open file" << std::endl;
-        throw std::invalid_argument{filename};
-    }
-
-    while (!file.eof()) {
-        datatype num;
-        file >> num;
-        data.push_back(num);
-    }
+    auto data = my::load_integers<datatype>(filename);
 
     {
         using namespace my::internal;
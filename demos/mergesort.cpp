@@ -47,4 +47,10 @@ time ./mergesort 1000    ->    0,004s
 time ./mergesort 10000   ->    0,012s
 time ./mergesort 100000  ->    0,727s
 time ./mergesort 1000000 ->   81,088s
+
+With a single scratch buffer instead of one allocation per recursion level:
+time ./mergesort 1000    ->    0,004s
+time ./mergesort 10000   ->    0,005s
+time ./mergesort 100000  ->    0,023s
+time ./mergesort 1000000 ->    0,229s
 */
\ No newline at end of file
@@ -4,9 +4,23 @@
 #include <functional>
 #include <algorithm>
 #include <iterator>
+#include <limits>
 #include <numeric>
 #include <cassert>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <execution>
+#include <forward_list>
+#include <initializer_list>
+#include <list>
+#include <mutex>
 #include <random>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace my
 {
@@ -19,22 +33,30 @@ struct AlgoConfig
     static std::ptrdiff_t MERGESORT_MIN_SIZE;
     static std::ptrdiff_t BINSEARCH_MIN_SIZE;
     static std::ptrdiff_t QUICKSORT_MIN_SIZE;
+    static std::ptrdiff_t PARALLEL_MIN_SIZE;
+    static std::size_t INPLACE_MERGESORT_BUFFER_BYTES;
+    static unsigned PARALLEL_TASKS; // Number of tasks the parallel algorithms split their work into
 
     enum QuicksortPivotChoice
     {
         FIRST,
         LAST,
         SAMPLE_3,
-        RANDOM
+        RANDOM,
+        NINTHER,
+        MEDIAN_OF_MEDIANS
     };
 
     static QuicksortPivotChoice QUICKSORT_PIVOT_CHOICE;
 };
 
-inline std::ptrdiff_t AlgoConfig::MERGESORT_MIN_SIZE = 100;
+inline std::ptrdiff_t AlgoConfig::MERGESORT_MIN_SIZE = 64;
 inline std::ptrdiff_t AlgoConfig::BINSEARCH_MIN_SIZE = 100;
-inline std::ptrdiff_t AlgoConfig::QUICKSORT_MIN_SIZE = 100;
-inline auto AlgoConfig::QUICKSORT_PIVOT_CHOICE = AlgoConfig::QuicksortPivotChoice::RANDOM;
+inline std::ptrdiff_t AlgoConfig::QUICKSORT_MIN_SIZE = 64;
+inline std::ptrdiff_t AlgoConfig::PARALLEL_MIN_SIZE = 1 << 14;
+inline std::size_t AlgoConfig::INPLACE_MERGESORT_BUFFER_BYTES = 4096;
+inline unsigned AlgoConfig::PARALLEL_TASKS = std::max(1u, std::thread::hardware_concurrency());
+inline AlgoConfig::QuicksortPivotChoice AlgoConfig::QUICKSORT_PIVOT_CHOICE = AlgoConfig::QuicksortPivotChoice::RANDOM;
 
 /// Component of insertion sort. Takes a sorted range [first, last) rotates moves the 'last' element to the right place.
 template <typename BiderectionalIterator, typename BinaryPredicate, typename SwapCounter>
@@ -55,7 +77,7 @@ BiderectionalIterator sort_last_forward(BiderectionalIterator first,
     return std::adjacent_find(rbegin,
                               rend,
                               [&](auto& right, auto& left) {
-                                  if (!comp(left, right)) {
+                                  if (comp(right, left)) {
                                       std::swap(left, right);
                                       if constexpr (count_swaps) {
                                           ++(*swaps);
@@ -91,10 +113,192 @@ void selection_sort_impl(InputIterator begin, InputIterator end, BinaryPredicate
     }
 }
 
+/// Moves the element at @root down the max-heap [ @begin , @begin + @size ) until the heap property holds.
+template <typename RandomAccessIterator, typename BinaryPredicate>
+void sift_down(RandomAccessIterator begin, std::ptrdiff_t root, std::ptrdiff_t size, BinaryPredicate compare)
+{
+    for (auto child = 2 * root + 1; child < size; child = 2 * root + 1) {
+        if (child + 1 < size && compare(begin[child], begin[child + 1])) {
+            ++child;
+        }
+        if (!compare(begin[root], begin[child])) {
+            return;
+        }
+        std::iter_swap(std::next(begin, root), std::next(begin, child));
+        root = child;
+    }
+}
+
+/// Moves the element at @node up the max-heap starting at @begin until the heap property holds.
+template <typename RandomAccessIterator, typename BinaryPredicate>
+void sift_up(RandomAccessIterator begin, std::ptrdiff_t node, BinaryPredicate compare)
+{
+    while (node > 0) {
+        const auto parent = (node - 1) / 2;
+        if (!compare(begin[parent], begin[node])) {
+            return;
+        }
+        std::iter_swap(std::next(begin, parent), std::next(begin, node));
+        node = parent;
+    }
+}
+
+/// Turns the max-heap [ @begin , @end ) into a sorted range
+template <typename RandomAccessIterator, typename BinaryPredicate>
+void sort_heap_impl(RandomAccessIterator begin, RandomAccessIterator end, BinaryPredicate compare)
+{
+    for (auto last = std::distance(begin, end) - 1; last > 0; --last) {
+        std::iter_swap(begin, std::next(begin, last));
+        sift_down(begin, 0, last, compare);
+    }
+}
+
+/// Gathers the first @middle - @begin values of [ @begin , @end ) in sorted order into a max-heap over the first ones
+template <typename RandomAccessIterator, typename BinaryPredicate>
+void heap_select_impl(RandomAccessIterator begin,
+                      RandomAccessIterator middle,
+                      RandomAccessIterator end,
+                      BinaryPredicate compare)
+{
+    const auto k = std::distance(begin, middle);
+    for (auto root = k / 2 - 1; root >= 0; --root) {
+        sift_down(begin, root, k, compare);
+    }
+    for (auto it = middle; it != end; ++it) {
+        if (compare(*it, *begin)) {
+            std::iter_swap(it, begin);
+            sift_down(begin, 0, k, compare);
+        }
+    }
+}
+
+/// In-situ heap-sort
+template <typename RandomAccessIterator, typename BinaryPredicate>
+void heap_sort_impl(RandomAccessIterator begin, RandomAccessIterator end, BinaryPredicate compare)
+{
+    const auto size = std::distance(begin, end);
+    for (auto root = size / 2 - 1; root >= 0; --root) {
+        sift_down(begin, root, size, compare);
+    }
+    sort_heap_impl(begin, end, compare);
+}
+
+/// Whether @BinaryPredicate orders arithmetic values of type T with the built-in `<` or `>`
+template <typename T, typename BinaryPredicate>
+constexpr bool is_builtin_order_v =
+  std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+  (std::is_same_v<BinaryPredicate, std::less<T>> || std::is_same_v<BinaryPredicate, std::less<>> ||
+   std::is_same_v<BinaryPredicate, std::greater<T>> || std::is_same_v<BinaryPredicate, std::greater<>>);
+
+/// Largest range that non_recursive_sort hands to a sorting network
+inline constexpr std::ptrdiff_t SORTING_NETWORK_MAX_SIZE = 64;
+
+/// Branch-free compare-exchange: leaves the lesser of @a and @b in @a, and the greater one in @b.
+template <typename T, typename BinaryPredicate>
+void compare_exchange(T& a, T& b, BinaryPredicate compare)
+{
+    const bool exchange = compare(b, a);
+    const T lesser = exchange ? b : a;
+    const T greater = exchange ? a : b;
+    a = lesser;
+    b = greater;
+}
+
+/// Compare-exchanges each entry of every block of 2 * Stride values at @values with the entry Stride places further
+template <std::size_t Size, std::size_t Stride, typename T, typename BinaryPredicate>
+void bitonic_clean(T* values, BinaryPredicate compare)
+{
+    for (std::size_t first = 0; first < Size; first += 2 * Stride) {
+        for (std::size_t i = 0; i < Stride; ++i) {
+            compare_exchange(values[first + i], values[first + Stride + i], compare);
+        }
+    }
+    if constexpr (Stride > 1) {
+        bitonic_clean<Size, Stride / 2>(values, compare);
+    }
+}
+
+/**
+ * Bitonic sorting network over the Size values at @values, Size being a power of two. Each stage merges pairs of sorted
+ * blocks by comparing mirrored entries, then cleans the halves up with shrinking strides. Strides are compile-time
+ * constants and every loop compares disjoint pairs without branching, so that compilers turn them into packed min/max
+ * instructions (SSE4.1, AVX2...) when the target supports them.
+ */
+template <std::size_t Size, std::size_t Block = 2, typename T, typename BinaryPredicate>
+void bitonic_sort(T* values, BinaryPredicate compare)
+{
+    static_assert(Size > 1 && (Size & (Size - 1)) == 0, "Size must be a power of two");
+
+    for (std::size_t first = 0; first < Size; first += Block) {
+        for (std::size_t i = 0; i < Block / 2; ++i) {
+            compare_exchange(values[first + i], values[first + Block - 1 - i], compare);
+        }
+    }
+    if constexpr (Block > 2) {
+        bitonic_clean<Size, Block / 4>(values, compare);
+    }
+    if constexpr (Block < Size) {
+        bitonic_sort<Size, 2 * Block>(values, compare);
+    }
+}
+
+/// Sorts the @size <= Size elements starting at @begin by padding them up to Size entries with greatest values
+template <std::size_t Size, typename ForwardIterator, typename BinaryPredicate>
+void padded_network_sort(ForwardIterator begin, std::ptrdiff_t size, BinaryPredicate compare)
+{
+    using T = typename std::iterator_traits<ForwardIterator>::value_type;
+    using Limits = std::numeric_limits<T>;
+    constexpr bool ascending =
+      std::is_same_v<BinaryPredicate, std::less<T>> || std::is_same_v<BinaryPredicate, std::less<>>;
+
+    T padding;
+    if constexpr (Limits::has_infinity) {
+        padding = ascending ? Limits::infinity() : -Limits::infinity();
+    } else {
+        padding = ascending ? Limits::max() : Limits::lowest();
+    }
+
+    std::array<T, Size> values;
+    std::fill(std::copy_n(begin, size, values.begin()), values.end(), padding);
+    bitonic_sort<Size>(values.data(), compare);
+    std::copy_n(values.cbegin(), size, begin);
+}
+
+/**
+ * In-situ sort of short ranges of arithmetic values with a sorting network. Ranges of up to 8, 16, 32 and 64 elements
+ * are padded up to the next size, so that the network is fixed at compile time.
+ */
+template <typename ForwardIterator, typename BinaryPredicate>
+void sorting_network_sort(ForwardIterator begin, std::ptrdiff_t size, BinaryPredicate compare)
+{
+    assert(size <= SORTING_NETWORK_MAX_SIZE);
+
+    if (size < 2) {
+        return;
+    } else if (size <= 8) {
+        padded_network_sort<8>(begin, size, compare);
+    } else if (size <= 16) {
+        padded_network_sort<16>(begin, size, compare);
+    } else if (size <= 32) {
+        padded_network_sort<32>(begin, size, compare);
+    } else {
+        padded_network_sort<64>(begin, size, compare);
+    }
+}
+
 // Non-recursive search algorithm metaprogramming
 template <typename Iterator, typename BinaryPredicate, typename SwapCounter>
 void non_recursive_sort(Iterator begin, Iterator end, BinaryPredicate compare, SwapCounter* swaps)
 {
+    if constexpr (std::is_same_v<SwapCounter, void> &&
+                  is_builtin_order_v<typename std::iterator_traits<Iterator>::value_type, BinaryPredicate>) {
+        const auto size = std::distance(begin, end);
+        if (size <= SORTING_NETWORK_MAX_SIZE) {
+            sorting_network_sort(begin, size, compare);
+            return;
+        }
+    }
+
     if constexpr (std::is_convertible<typename std::iterator_traits<Iterator>::iterator_category,
                                       std::bidirectional_iterator_tag>::value) {
         insertion_sort_impl<Iterator, BinaryPredicate, SwapCounter>(begin, end, compare, swaps);
@@ -107,19 +311,89 @@ void non_recursive_sort(Iterator begin, Iterator end, BinaryPredicate compare, S
 
 }
 
+namespace internal
+{
+
+/// Binary search for the partition point among the @size entries starting at @begin. Advances O(size) times.
+template <typename ForwardIterator, typename UnaryPredicate>
+ForwardIterator partition_point_n(ForwardIterator begin, std::ptrdiff_t size, UnaryPredicate pred)
+{
+    while (size > 0) {
+        const auto half = size / 2;
+        auto middle = std::next(begin, half);
+        if (pred(*middle)) {
+            begin = std::next(middle);
+            size -= half + 1;
+        } else {
+            size = half;
+        }
+    }
+    return begin;
+}
+
+} // namespace internal
+
+/**
+ * Galloping (exponential) search for the partition point of [ @begin , @end ), partitioned with respect to @pred.
+ * Entries 1, 2, 4, 8... places further along are probed until @pred fails, and the last stride is then binary
+ * searched.
+ *
+ * Complexity: O(log p) predicate calls, p being the distance from @begin to the partition point: faster than a plain
+ * binary search when the answer is near the front. Forward iterators are advanced O(p) times, and the end of the
+ * range is never measured.
+ */
+template <typename ForwardIterator, typename UnaryPredicate>
+ForwardIterator gallop_partition_point(ForwardIterator begin, ForwardIterator end, UnaryPredicate pred)
+{
+    if constexpr (std::is_convertible<typename std::iterator_traits<ForwardIterator>::iterator_category,
+                                      std::random_access_iterator_tag>::value) {
+        const auto size = std::distance(begin, end);
+        std::ptrdiff_t lower = 0;
+        std::ptrdiff_t bound = 1;
+        while (bound <= size && pred(begin[bound - 1])) {
+            lower = bound;
+            bound *= 2;
+        }
+        return internal::partition_point_n(std::next(begin, lower), std::min(bound - 1, size) - lower, pred);
+    } else {
+        // The predicate holds for every entry before begin
+        for (std::ptrdiff_t stride = 1;; stride *= 2) {
+            auto probe = begin;
+            std::ptrdiff_t advanced = 0;
+            for (; advanced < stride - 1 && probe != end; ++advanced) {
+                ++probe;
+            }
+            if (probe == end || !pred(*probe)) {
+                return internal::partition_point_n(begin, advanced, pred);
+            }
+            begin = std::next(probe);
+        }
+    }
+}
+
+/**
+ * Partition point of [ @begin , @end ), partitioned with respect to @pred. Random access ranges are binary searched.
+ * Other ranges are searched by galloping, which advances iterators O(n) times in total instead of measuring and
+ * splitting the range at every step.
+ */
 template <typename InputIterator, typename UnaryPredicate>
 InputIterator sorted_partition_point(InputIterator begin, InputIterator end, UnaryPredicate pred)
 {
-    const auto size = std::distance(begin, end);
-    if (size < internal::AlgoConfig::BINSEARCH_MIN_SIZE) {
-        return std::partition_point(begin, end, pred);
-    }
+    if constexpr (!std::is_convertible<typename std::iterator_traits<InputIterator>::iterator_category,
+                                       std::random_access_iterator_tag>::value) {
+        return gallop_partition_point(begin, end, pred);
+    } else {
+        const auto size = std::distance(begin, end);
+        if (size < internal::AlgoConfig::BINSEARCH_MIN_SIZE) {
+            return std::partition_point(begin, end, pred);
+        }
 
-    const auto midpoint = std::next(begin, size / 2);
-    if (pred(*midpoint)) {
-        return sorted_partition_point(midpoint, end, pred);
+        const auto midpoint = std::next(begin, size / 2);
+        if (pred(*midpoint)) {
+            return sorted_partition_point(midpoint, end, pred);
+        }
+        return sorted_partition_point(begin, midpoint, pred);
     }
-    return sorted_partition_point(begin, midpoint, pred);
 }
 
 namespace internal
@@ -139,189 +413,2261 @@ OutputIterator merge_impl(LInputIterator left_begin,
                           SwapCounter* swaps = nullptr)
 {
     constexpr bool count_swaps = !std::is_same_v<SwapCounter, void>;
-    [[maybe_unused]] const auto left_size = std::distance(left_begin, left_end);
+    [[maybe_unused]] auto left_remaining = count_swaps ? std::distance(left_begin, left_end) : 0;
 
     auto it = out_begin;
     auto left = left_begin;
     auto right = right_begin;
 
+    // Left elements go first on ties, which keeps the merge stable
     while (left != left_end && right != right_end) {
-        bool comp = compare(*left, *right);
+        bool comp = !compare(*right, *left);
 
+        // Every left element not merged yet is an inversion with a right element merged before it
         if constexpr (count_swaps) {
-            auto from = comp ? std::distance(left_begin, left) : left_size + std::distance(right_begin, right);
-            auto to = std::distance(out_begin, it);
-            *swaps += from - to;
+            if (comp) {
+                --left_remaining;
+            } else {
+                *swaps += left_remaining;
+            }
+        }
+
+        auto& ptr = comp ? left : right;
+        *it = *ptr;
+        std::advance(ptr, 1);
+        std::advance(it, 1);
+    }
+
+    if (right == right_end) {
+        return std::copy(left, left_end, it);
+    }
+    return std::copy(right, right_end, it);
+}
+
+template <typename SortIterator, typename ScratchIterator, typename BinaryPredicate, typename SwapCounter>
+void merge_sort_to(SortIterator begin,
+                   std::ptrdiff_t size,
+                   ScratchIterator scratch,
+                   BinaryPredicate compare,
+                   SwapCounter* swaps);
+
+/**
+ * Merge-sort of [ @begin , @begin + @size ) in place. The range starting at @scratch must hold at least @size
+ * elements, and is used as working memory: its contents are left unspecified.
+ */
+template <typename SortIterator, typename ScratchIterator, typename BinaryPredicate, typename SwapCounter>
+void merge_sort_in_place(SortIterator begin,
+                         std::ptrdiff_t size,
+                         ScratchIterator scratch,
+                         BinaryPredicate compare,
+                         SwapCounter* swaps)
+{
+    if (size < std::max<std::ptrdiff_t>(AlgoConfig::MERGESORT_MIN_SIZE, 2)) {
+        non_recursive_sort<SortIterator, BinaryPredicate, SwapCounter>(
+          begin, std::next(begin, size), compare, swaps);
+        return;
+    }
+
+    const auto half = size / 2;
+    auto middle = std::next(begin, half);
+    auto scratch_middle = std::next(scratch, half);
+
+    // Both halves end up sorted in the scratch area, and are then merged back
+    merge_sort_to<SortIterator, ScratchIterator, BinaryPredicate, SwapCounter>(begin, half, scratch, compare, swaps);
+    merge_sort_to<SortIterator, ScratchIterator, BinaryPredicate, SwapCounter>(
+      middle, size - half, scratch_middle, compare, swaps);
+
+    my::internal::merge_impl(std::move_iterator(scratch),
+                             std::move_iterator(scratch_middle),
+                             std::move_iterator(scratch_middle),
+                             std::move_iterator(std::next(scratch_middle, size - half)),
+                             begin,
+                             compare,
+                             swaps);
+}
+
+/**
+ * Merge-sort of [ @begin , @begin + @size ) into the range starting at @scratch. The input range is used as working
+ * memory: its contents are left unspecified.
+ */
+template <typename SortIterator, typename ScratchIterator, typename BinaryPredicate, typename SwapCounter>
+void merge_sort_to(SortIterator begin,
+                   std::ptrdiff_t size,
+                   ScratchIterator scratch,
+                   BinaryPredicate compare,
+                   SwapCounter* swaps)
+{
+    if (size < std::max<std::ptrdiff_t>(AlgoConfig::MERGESORT_MIN_SIZE, 2)) {
+        auto end = std::next(begin, size);
+        non_recursive_sort<SortIterator, BinaryPredicate, SwapCounter>(begin, end, compare, swaps);
+        std::move(begin, end, scratch);
+        return;
+    }
+
+    const auto half = size / 2;
+    auto middle = std::next(begin, half);
+    auto scratch_middle = std::next(scratch, half);
+
+    // Both halves end up sorted in place, and are then merged into the scratch area
+    merge_sort_in_place<SortIterator, ScratchIterator, BinaryPredicate, SwapCounter>(
+      begin, half, scratch, compare, swaps);
+    merge_sort_in_place<SortIterator, ScratchIterator, BinaryPredicate, SwapCounter>(
+      middle, size - half, scratch_middle, compare, swaps);
+
+    my::internal::merge_impl(std::move_iterator(begin),
+                             std::move_iterator(middle),
+                             std::move_iterator(middle),
+                             std::move_iterator(std::next(middle, size - half)),
+                             scratch,
+                             compare,
+                             swaps);
+}
+
+/**
+ * Merge-sort
+ *
+ * The input is copied into @buffer, which must hold at least as many elements as the input. The sort then ping-pongs
+ * between @buffer and the output range, so no further memory is allocated.
+ */
+template <typename InputIterator,
+          typename OutputIterator,
+          typename BufferIterator,
+          typename BinaryPredicate,
+          typename SwapCounter>
+OutputIterator merge_sort_impl(InputIterator begin,
+                               InputIterator end,
+                               OutputIterator out_begin,
+                               BufferIterator buffer,
+                               BinaryPredicate compare,
+                               SwapCounter* swaps)
+{
+    const auto buffer_end = std::copy(begin, end, buffer);
+    const auto size = std::distance(buffer, buffer_end);
+
+    merge_sort_to<BufferIterator, OutputIterator, BinaryPredicate, SwapCounter>(
+      buffer, size, out_begin, compare, swaps);
+    return std::next(out_begin, size);
+}
+
+/// Merge-sort, allocating a single buffer the size of the input
+template <typename InputIterator, typename OutputIterator, typename BinaryPredicate, typename SwapCounter>
+OutputIterator merge_sort_impl(InputIterator begin,
+                               InputIterator end,
+                               OutputIterator out_begin,
+                               BinaryPredicate compare,
+                               SwapCounter* swaps)
+{
+    using value_type = typename std::iterator_traits<InputIterator>::value_type;
+    std::vector<value_type> buffer(begin, end);
+
+    const auto size = static_cast<std::ptrdiff_t>(buffer.size());
+
+    merge_sort_to<decltype(buffer.begin()), OutputIterator, BinaryPredicate, SwapCounter>(
+      buffer.begin(), size, out_begin, compare, swaps);
+    return std::next(out_begin, size);
+}
+
+template <typename ExecutionPolicy>
+constexpr bool is_parallel_policy()
+{
+    return !std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>;
+}
+
+/**
+ * Work-stealing pool that runs the tasks of fork_join and parallel_for, so that nested forks reuse a fixed set of
+ * threads instead of starting one each. Every worker pushes and pops its own tasks at the back of its deque, and idle
+ * threads steal the oldest task of another deque; threads outside the pool share one more deque. A thread waiting for
+ * a task runs queued tasks meanwhile, so a fork never blocks a worker. A single lock guards the deques: tasks are
+ * coarse, about AlgoConfig::PARALLEL_TASKS of them per call.
+ */
+class task_pool
+{
+  public:
+    /// A queued task. It must outlive the call to wait() on it.
+    struct job
+    {
+        explicit job(std::function<void()> task)
+          : run(std::move(task))
+        {
+        }
+
+        std::function<void()> run;
+        bool done = false;
+        std::exception_ptr error;
+    };
+
+    /// The pool shared by all parallel algorithms, with a worker per hardware thread besides the calling one
+    static task_pool& instance()
+    {
+        static task_pool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    explicit task_pool(unsigned n_workers)
+      : queues_(n_workers + 1)
+    {
+        workers_.reserve(n_workers);
+        for (unsigned i = 0; i < n_workers; ++i) {
+            workers_.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    task_pool(const task_pool&) = delete;
+    task_pool& operator=(const task_pool&) = delete;
+
+    ~task_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        std::for_each(workers_.begin(), workers_.end(), [](auto& worker) { worker.join(); });
+    }
+
+    void submit(job& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queues_[own_queue()].push_back(&task);
+        }
+        wakeup_.notify_one();
+    }
+
+    /// Runs queued tasks until @task is done. Its exception, if any, is left in task.error.
+    void wait(job& task)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const auto queue = own_queue();
+        while (!task.done) {
+            if (auto* next = pop(queue)) {
+                run(*next, lock);
+            } else {
+                wakeup_.wait(lock);
+            }
+        }
+    }
+
+  private:
+    static unsigned& worker_index()
+    {
+        thread_local unsigned index = std::numeric_limits<unsigned>::max();
+        return index;
+    }
+
+    std::size_t own_queue() const
+    {
+        return std::min<std::size_t>(worker_index(), workers_.size());
+    }
+
+    void work(unsigned index)
+    {
+        worker_index() = index;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            if (auto* next = pop(index)) {
+                run(*next, lock);
+            } else {
+                wakeup_.wait(lock);
+            }
+        }
+    }
+
+    /// Newest task of deque @queue, or else the oldest task of another deque
+    job* pop(std::size_t queue)
+    {
+        if (!queues_[queue].empty()) {
+            auto* task = queues_[queue].back();
+            queues_[queue].pop_back();
+            return task;
+        }
+        for (std::size_t i = 1; i < queues_.size(); ++i) {
+            auto& victim = queues_[(queue + i) % queues_.size()];
+            if (!victim.empty()) {
+                auto* task = victim.front();
+                victim.pop_front();
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    void run(job& task, std::unique_lock<std::mutex>& lock)
+    {
+        lock.unlock();
+        try {
+            task.run();
+        } catch (...) {
+            task.error = std::current_exception();
+        }
+        lock.lock();
+        task.done = true;
+        wakeup_.notify_all();
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::vector<std::deque<job*>> queues_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+};
+
+/// Queues @first on the task pool, runs @second in the current thread, and waits for both to finish.
+template <typename FirstTask, typename SecondTask>
+void fork_join(FirstTask&& first, SecondTask&& second)
+{
+    auto& pool = task_pool::instance();
+    task_pool::job forked{std::forward<FirstTask>(first)};
+    pool.submit(forked);
+
+    std::exception_ptr error;
+    try {
+        second();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    pool.wait(forked);
+    if (!error) {
+        error = forked.error;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/// Calls @task(i) for every i in [0, @n_tasks) on the task pool, and waits for all of them. Task 0 runs in this thread.
+template <typename Task>
+void parallel_for(unsigned n_tasks, Task&& task)
+{
+    auto& pool = task_pool::instance();
+    std::vector<task_pool::job> jobs;
+    jobs.reserve(n_tasks);
+    for (unsigned i = 1; i < n_tasks; ++i) {
+        jobs.emplace_back([&task, i] { task(i); });
+        pool.submit(jobs.back());
+    }
+
+    std::exception_ptr error;
+    try {
+        if (n_tasks != 0) {
+            task(0u);
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    for (auto& job : jobs) {
+        pool.wait(job);
+        if (!error) {
+            error = job.error;
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * Merge-path partitioning. Given two sorted ranges, returns how many elements of the left one are among the first
+ * @diagonal elements of their merge, in the same order merge_impl would produce it.
+ *
+ * Complexity: O(log(min(@left_size, @right_size))) comparisons.
+ */
+template <typename LRandomAccessIterator, typename RRandomAccessIterator, typename BinaryPredicate>
+std::ptrdiff_t merge_path_split(LRandomAccessIterator left_begin,
+                                std::ptrdiff_t left_size,
+                                RRandomAccessIterator right_begin,
+                                std::ptrdiff_t right_size,
+                                std::ptrdiff_t diagonal,
+                                BinaryPredicate compare)
+{
+    auto lo = std::max<std::ptrdiff_t>(0, diagonal - right_size);
+    auto hi = std::min(diagonal, left_size);
+
+    // Largest number of left elements such that the last of them precedes the next right element (left first on ties)
+    while (lo < hi) {
+        const auto mid = lo + (hi - lo + 1) / 2;
+        if (!compare(right_begin[diagonal - mid], left_begin[mid - 1])) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
         }
+    }
+    return lo;
+}
+
+/**
+ * Moves the merge of two sorted ranges into @out_begin. The output is split into @n_tasks slices with merge-path
+ * partitioning, and the slices are merged concurrently.
+ */
+template <typename LRandomAccessIterator,
+          typename RRandomAccessIterator,
+          typename RandomAccessOutputIterator,
+          typename BinaryPredicate>
+void parallel_merge_impl(LRandomAccessIterator left_begin,
+                         LRandomAccessIterator left_end,
+                         RRandomAccessIterator right_begin,
+                         RRandomAccessIterator right_end,
+                         RandomAccessOutputIterator out_begin,
+                         BinaryPredicate compare,
+                         unsigned n_tasks)
+{
+    const auto left_size = std::distance(left_begin, left_end);
+    const auto right_size = std::distance(right_begin, right_end);
+    const auto size = left_size + right_size;
+    const auto slice = (size + n_tasks - 1) / n_tasks;
+
+    parallel_for(n_tasks, [&](unsigned task) {
+        const auto first_diagonal = std::min<std::ptrdiff_t>(size, task * slice);
+        const auto last_diagonal = std::min(size, first_diagonal + slice);
+        const auto l0 = merge_path_split(left_begin, left_size, right_begin, right_size, first_diagonal, compare);
+        const auto l1 = merge_path_split(left_begin, left_size, right_begin, right_size, last_diagonal, compare);
+
+        merge_impl(std::move_iterator(std::next(left_begin, l0)),
+                   std::move_iterator(std::next(left_begin, l1)),
+                   std::move_iterator(std::next(right_begin, first_diagonal - l0)),
+                   std::move_iterator(std::next(right_begin, last_diagonal - l1)),
+                   std::next(out_begin, first_diagonal),
+                   compare);
+    });
+}
+
+template <typename SortIterator, typename ScratchIterator, typename BinaryPredicate>
+void parallel_merge_sort_to(SortIterator begin,
+                            std::ptrdiff_t size,
+                            ScratchIterator scratch,
+                            BinaryPredicate compare,
+                            unsigned n_tasks);
+
+/// Parallel counterpart of merge_sort_in_place. Work is split among @n_tasks concurrent tasks.
+template <typename SortIterator, typename ScratchIterator, typename BinaryPredicate>
+void parallel_merge_sort_in_place(SortIterator begin,
+                                  std::ptrdiff_t size,
+                                  ScratchIterator scratch,
+                                  BinaryPredicate compare,
+                                  unsigned n_tasks)
+{
+    if (n_tasks < 2 || size < AlgoConfig::PARALLEL_MIN_SIZE) {
+        merge_sort_in_place<SortIterator, ScratchIterator, BinaryPredicate, void>(
+          begin, size, scratch, compare, nullptr);
+        return;
+    }
+
+    const auto half = size / 2;
+    auto middle = std::next(begin, half);
+    auto scratch_middle = std::next(scratch, half);
+
+    fork_join([&] { parallel_merge_sort_to(begin, half, scratch, compare, n_tasks / 2); },
+              [&] { parallel_merge_sort_to(middle, size - half, scratch_middle, compare, n_tasks - n_tasks / 2); });
+
+    parallel_merge_impl(scratch, scratch_middle, scratch_middle, std::next(scratch_middle, size - half), begin,
+                        compare, n_tasks);
+}
+
+/// Parallel counterpart of merge_sort_to. Work is split among @n_tasks concurrent tasks.
+template <typename SortIterator, typename ScratchIterator, typename BinaryPredicate>
+void parallel_merge_sort_to(SortIterator begin,
+                            std::ptrdiff_t size,
+                            ScratchIterator scratch,
+                            BinaryPredicate compare,
+                            unsigned n_tasks)
+{
+    if (n_tasks < 2 || size < AlgoConfig::PARALLEL_MIN_SIZE) {
+        merge_sort_to<SortIterator, ScratchIterator, BinaryPredicate, void>(begin, size, scratch, compare, nullptr);
+        return;
+    }
+
+    const auto half = size / 2;
+    auto middle = std::next(begin, half);
+    auto scratch_middle = std::next(scratch, half);
+
+    fork_join(
+      [&] { parallel_merge_sort_in_place(begin, half, scratch, compare, n_tasks / 2); },
+      [&] { parallel_merge_sort_in_place(middle, size - half, scratch_middle, compare, n_tasks - n_tasks / 2); });
+
+    parallel_merge_impl(begin, middle, middle, std::next(middle, size - half), scratch, compare, n_tasks);
+}
+
+}
+
+/** Splits the array into two parts. The first part is composed of all entries that
+ * fulfil the predicate. Those that don't, are moved to the second part. The first
+ * item of the second part is returned.
+ */
+
+template <typename Iterator, typename UnaryPredicate>
+Iterator partition(Iterator begin, Iterator end, UnaryPredicate pred)
+{
+    if (begin == end) {
+        return begin;
+    }
+    auto partition_point = begin;
+    for (; begin != end; std::advance(begin, 1)) {
+        if (pred(*begin)) {
+            std::iter_swap(partition_point, begin);
+            std::advance(partition_point, 1);
+        }
+    }
+    return partition_point;
+}
+
+/**
+ * Branchless block partition (Edelkamp & Weiss' BlockQuicksort). Same contract as my::partition, for random-access
+ * ranges.
+ *
+ * Blocks of entries are scanned from both ends, and the offsets of misplaced entries are recorded without branching
+ * on the predicate. Misplaced entries are then swapped pairwise in batches. Only the final couple of blocks are
+ * partitioned entry by entry.
+ */
+template <typename RandomAccessIterator, typename UnaryPredicate>
+RandomAccessIterator block_partition(RandomAccessIterator begin, RandomAccessIterator end, UnaryPredicate pred)
+{
+    static_assert(std::is_convertible<typename std::iterator_traits<RandomAccessIterator>::iterator_category,
+                                      std::random_access_iterator_tag>::value,
+                  "RandomAccessIterator must be random-access");
+
+    constexpr std::ptrdiff_t block_size = 64;
+
+    std::array<std::uint8_t, block_size> offsets_left;
+    std::array<std::uint8_t, block_size> offsets_right;
+    std::ptrdiff_t start_left = 0;
+    std::ptrdiff_t start_right = 0;
+    std::ptrdiff_t n_left = 0;  // Misplaced entries pending in the left block
+    std::ptrdiff_t n_right = 0; // Misplaced entries pending in the right block
+
+    // Invariant: [begin, left) fulfil the predicate, [right, end) do not
+    auto left = begin;
+    auto right = end;
+
+    while (std::distance(left, right) > 2 * block_size) {
+        if (n_left == 0) {
+            start_left = 0;
+            for (std::ptrdiff_t i = 0; i < block_size; ++i) {
+                offsets_left[n_left] = static_cast<std::uint8_t>(i);
+                n_left += !pred(left[i]);
+            }
+        }
+        if (n_right == 0) {
+            start_right = 0;
+            for (std::ptrdiff_t i = 0; i < block_size; ++i) {
+                offsets_right[n_right] = static_cast<std::uint8_t>(i);
+                n_right += static_cast<bool>(pred(right[-1 - i]));
+            }
+        }
+
+        const auto n_swaps = std::min(n_left, n_right);
+        for (std::ptrdiff_t i = 0; i < n_swaps; ++i) {
+            std::iter_swap(left + offsets_left[start_left + i], right - 1 - offsets_right[start_right + i]);
+        }
+
+        n_left -= n_swaps;
+        n_right -= n_swaps;
+        start_left += n_swaps;
+        start_right += n_swaps;
+
+        if (n_left == 0) {
+            left += block_size;
+        }
+        if (n_right == 0) {
+            right -= block_size;
+        }
+    }
+
+    return my::partition(left, right, pred);
+}
+
+namespace internal
+{
+
+/// Whether partitioning this kind of range should go through my::block_partition
+template <typename Iterator>
+constexpr bool use_block_partition()
+{
+    return std::is_convertible<typename std::iterator_traits<Iterator>::iterator_category,
+                               std::random_access_iterator_tag>::value &&
+           std::is_trivially_copyable<typename std::iterator_traits<Iterator>::value_type>::value;
+}
+
+/// my::block_partition where it pays off, my::partition otherwise
+template <typename Iterator, typename UnaryPredicate>
+Iterator fast_partition(Iterator begin, Iterator end, UnaryPredicate pred)
+{
+    if constexpr (use_block_partition<Iterator>()) {
+        return my::block_partition(begin, end, pred);
+    } else {
+        return my::partition(begin, end, pred);
+    }
+}
+
+/**
+ * Partition split among up to @n_tasks concurrent tasks. Every task partitions its own chunk of the range, and then
+ * the entries left on the wrong side of the global partition point are swapped across, again in parallel.
+ */
+template <typename RandomAccessIterator, typename UnaryPredicate>
+RandomAccessIterator parallel_partition(RandomAccessIterator begin,
+                                        RandomAccessIterator end,
+                                        UnaryPredicate pred,
+                                        unsigned n_tasks)
+{
+    const auto size = std::distance(begin, end);
+    const auto n_chunks = static_cast<unsigned>(
+      std::clamp<std::ptrdiff_t>(size / AlgoConfig::PARALLEL_MIN_SIZE, 1, std::max(n_tasks, 1u)));
+    if (n_chunks < 2) {
+        return fast_partition(begin, end, pred);
+    }
+
+    const auto chunk = (size + n_chunks - 1) / n_chunks;
+    const auto chunk_begin = [&](unsigned k) { return std::min<std::ptrdiff_t>(size, k * chunk); };
+
+    std::vector<std::ptrdiff_t> chunk_points(n_chunks);
+    parallel_for(n_chunks, [&](unsigned k) {
+        chunk_points[k] = std::distance(
+          begin, fast_partition(std::next(begin, chunk_begin(k)), std::next(begin, chunk_begin(k + 1)), pred));
+    });
+
+    std::ptrdiff_t partition_point = 0;
+    for (unsigned k = 0; k < n_chunks; ++k) {
+        partition_point += chunk_points[k] - chunk_begin(k);
+    }
+
+    // Intervals [first, last) of entries on the wrong side of the partition point
+    std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>> misplaced_false;
+    std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>> misplaced_true;
+    std::ptrdiff_t n_misplaced = 0;
+    for (unsigned k = 0; k < n_chunks; ++k) {
+        if (chunk_points[k] < partition_point && chunk_points[k] < chunk_begin(k + 1)) {
+            misplaced_false.emplace_back(chunk_points[k], std::min(chunk_begin(k + 1), partition_point));
+            n_misplaced += misplaced_false.back().second - misplaced_false.back().first;
+        }
+        if (chunk_points[k] > partition_point && chunk_begin(k) < chunk_points[k]) {
+            misplaced_true.emplace_back(std::max(chunk_begin(k), partition_point), chunk_points[k]);
+        }
+    }
+
+    // Returns the interval and the offset within it of the @n th misplaced entry
+    const auto locate = [](const auto& intervals, std::ptrdiff_t n) {
+        std::size_t i = 0;
+        for (; i < intervals.size() && n >= intervals[i].second - intervals[i].first; ++i) {
+            n -= intervals[i].second - intervals[i].first;
+        }
+        return std::make_pair(i, n);
+    };
+
+    const auto slice = (n_misplaced + n_chunks - 1) / n_chunks;
+    parallel_for(n_chunks, [&](unsigned k) {
+        auto remaining = std::min(slice, std::max<std::ptrdiff_t>(0, n_misplaced - k * slice));
+        auto [f, f_offset] = locate(misplaced_false, k * slice);
+        auto [t, t_offset] = locate(misplaced_true, k * slice);
+
+        while (remaining > 0) {
+            const auto f_first = misplaced_false[f].first + f_offset;
+            const auto t_first = misplaced_true[t].first + t_offset;
+            const auto n =
+              std::min({remaining, misplaced_false[f].second - f_first, misplaced_true[t].second - t_first});
+
+            std::swap_ranges(std::next(begin, f_first), std::next(begin, f_first + n), std::next(begin, t_first));
+
+            remaining -= n;
+            f_offset += n;
+            t_offset += n;
+            if (misplaced_false[f].first + f_offset == misplaced_false[f].second) {
+                ++f;
+                f_offset = 0;
+            }
+            if (misplaced_true[t].first + t_offset == misplaced_true[t].second) {
+                ++t;
+                t_offset = 0;
+            }
+        }
+    });
+
+    return std::next(begin, partition_point);
+}
+
+} // namespace internal
+
+/**
+ * Dutch national flag partition. Reorders the range into three parts: entries that compare less than @pivot, entries
+ * equivalent to it, and entries that compare greater. Returns the boundaries between the first and second part, and
+ * between the second and third.
+ *
+ * @pivot must not refer to an element of the range, as elements are swapped around.
+ *
+ * Complexity: a single pass for bidirectional iterators. Two passes for forward iterators, and for random-access
+ * ranges of trivially copyable types, which use my::block_partition.
+ */
+template <typename Iterator, typename T, typename BinaryPredicate>
+std::pair<Iterator, Iterator> partition_three_way(Iterator begin, Iterator end, const T& pivot, BinaryPredicate compare)
+{
+    if constexpr (internal::use_block_partition<Iterator>()) {
+        // Two branchless passes beat a single branchy one
+        auto less_end = my::block_partition(begin, end, [&](const auto& x) { return compare(x, pivot); });
+        auto greater_begin = my::block_partition(less_end, end, [&](const auto& x) { return !compare(pivot, x); });
+        return {less_end, greater_begin};
+    } else if constexpr (std::is_convertible<typename std::iterator_traits<Iterator>::iterator_category,
+                                             std::bidirectional_iterator_tag>::value) {
+        auto less_end = begin;
+        auto greater_begin = end;
+        while (begin != greater_begin) {
+            if (compare(*begin, pivot)) {
+                std::iter_swap(less_end++, begin++);
+            } else if (compare(pivot, *begin)) {
+                std::iter_swap(begin, --greater_begin);
+            } else {
+                ++begin;
+            }
+        }
+        return {less_end, greater_begin};
+    } else {
+        auto less_end = my::partition(begin, end, [&](const auto& x) { return compare(x, pivot); });
+        auto greater_begin = my::partition(less_end, end, [&](const auto& x) { return !compare(pivot, x); });
+        return {less_end, greater_begin};
+    }
+}
+
+template <typename InputIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<InputIterator>::value_type>>
+void insertion_sort(InputIterator begin, InputIterator end, BinaryPredicate compare = BinaryPredicate{})
+{
+    internal::insertion_sort_impl<InputIterator, BinaryPredicate, void>(begin, end, compare, nullptr);
+}
+
+template <typename InputIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<InputIterator>::value_type>>
+void selection_sort(InputIterator begin, InputIterator end, BinaryPredicate compare = BinaryPredicate{})
+{
+    internal::selection_sort_impl<InputIterator, BinaryPredicate>(begin, end, compare);
+}
+
+template <typename RandomAccessIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>>
+void heap_sort(RandomAccessIterator begin, RandomAccessIterator end, BinaryPredicate compare = BinaryPredicate{})
+{
+    internal::heap_sort_impl<RandomAccessIterator, BinaryPredicate>(begin, end, compare);
+}
+
+template <typename LInputIterator, typename RInputIterator, typename OutputIterator, typename BinaryPredicate>
+OutputIterator merge(LInputIterator left_begin,
+                     LInputIterator left_end,
+                     RInputIterator right_begin,
+                     RInputIterator right_end,
+                     OutputIterator out_begin,
+                     BinaryPredicate compare)
+{
+    return internal::merge_impl<LInputIterator, RInputIterator, OutputIterator, BinaryPredicate, void>(
+      left_begin, left_end, right_begin, right_end, out_begin, compare, nullptr);
+}
+
+template <typename InputIterator,
+          typename OutputIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<InputIterator>::value_type>>
+OutputIterator merge_sort(InputIterator begin,
+                          InputIterator end,
+                          OutputIterator out_begin,
+                          BinaryPredicate compare = BinaryPredicate{})
+{
+    return internal::merge_sort_impl<InputIterator, OutputIterator, BinaryPredicate, void>(
+      begin, end, out_begin, compare, nullptr);
+}
+
+/**
+ * Merge-sort with an execution policy. Parallel policies sort both halves concurrently and split every merge among
+ * threads with merge-path partitioning. std::execution::seq falls back to the serial merge_sort.
+ */
+template <typename ExecutionPolicy,
+          typename RandomAccessIterator,
+          typename RandomAccessOutputIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>>
+std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>, RandomAccessOutputIterator> merge_sort(
+  ExecutionPolicy&&,
+  RandomAccessIterator begin,
+  RandomAccessIterator end,
+  RandomAccessOutputIterator out_begin,
+  BinaryPredicate compare = BinaryPredicate{})
+{
+    if constexpr (!internal::is_parallel_policy<ExecutionPolicy>()) {
+        return merge_sort(begin, end, out_begin, compare);
+    } else {
+        static_assert(std::is_convertible<typename std::iterator_traits<RandomAccessIterator>::iterator_category,
+                                          std::random_access_iterator_tag>::value,
+                      "RandomAccessIterator must be random-access");
+        static_assert(std::is_convertible<typename std::iterator_traits<RandomAccessOutputIterator>::iterator_category,
+                                          std::random_access_iterator_tag>::value,
+                      "RandomAccessOutputIterator must be random-access");
+
+        using value_type = typename std::iterator_traits<RandomAccessIterator>::value_type;
+        std::vector<value_type> buffer(begin, end);
+        const auto size = static_cast<std::ptrdiff_t>(buffer.size());
+
+        internal::parallel_merge_sort_to(
+          buffer.begin(), size, out_begin, compare, internal::AlgoConfig::PARALLEL_TASKS);
+        return std::next(out_begin, size);
+    }
+}
+
+/**
+ * Merge-sort using caller-supplied working memory. The range starting at @buffer must hold at least as many elements
+ * as [ @begin , @end ). Its contents are left unspecified. No memory is allocated.
+ */
+template <typename InputIterator,
+          typename OutputIterator,
+          typename BufferIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<InputIterator>::value_type>>
+OutputIterator merge_sort_buffered(InputIterator begin,
+                                   InputIterator end,
+                                   OutputIterator out_begin,
+                                   BufferIterator buffer,
+                                   BinaryPredicate compare = BinaryPredicate{})
+{
+    return internal::merge_sort_impl<InputIterator, OutputIterator, BufferIterator, BinaryPredicate, void>(
+      begin, end, out_begin, buffer, compare, nullptr);
+}
+
+namespace internal
+{
+
+/// Stable in-situ insertion sort: every element is inserted after all the ones that compare equal to it.
+template <typename RandomAccessIterator, typename BinaryPredicate>
+void stable_insertion_sort_impl(RandomAccessIterator begin, RandomAccessIterator end, BinaryPredicate compare)
+{
+    if (begin == end) {
+        return;
+    }
+    for (auto it = std::next(begin); it != end; ++it) {
+        if (!compare(*it, *std::prev(it))) {
+            continue;
+        }
+        auto value = std::move(*it);
+        auto hole = it;
+        do {
+            *hole = std::move(*std::prev(hole));
+            --hole;
+        } while (hole != begin && compare(value, *std::prev(hole)));
+        *hole = std::move(value);
+    }
+}
+
+/**
+ * Stable merge of the consecutive sorted ranges [ @first , @middle ) and [ @middle , @last ), in linear time. The left
+ * range is moved to @cache, which must have room for it, and merged back. @cache is reserved up front and never grows.
+ */
+template <typename RandomAccessIterator, typename BinaryPredicate, typename Cache>
+void cache_merge(RandomAccessIterator first,
+                 RandomAccessIterator middle,
+                 RandomAccessIterator last,
+                 BinaryPredicate compare,
+                 Cache& cache)
+{
+    assert(std::distance(first, middle) <= static_cast<std::ptrdiff_t>(cache.capacity()));
+
+    cache.assign(std::move_iterator(first), std::move_iterator(middle));
+    auto left = cache.begin();
+    auto right = middle;
+    auto out = first;
+    while (left != cache.end() && right != last) {
+        const bool take_right = compare(*right, *left);
+        *out++ = std::move(take_right ? *right : *left);
+        right += take_right;
+        left += !take_right;
+    }
+    std::move(left, cache.end(), out);
+    cache.clear();
+}
+
+/**
+ * Moves up to @wanted pairwise distinct entries of [ @begin , @end ) to the front of the range, sorted, and returns how
+ * many it found: fewer only if the range holds fewer distinct values. Each key is the first of its equal entries and
+ * the other entries keep their order, so merging the keys back ahead of equal entries keeps the range stable.
+ *
+ * Complexity: O(n log k + k^2) for k keys.
+ */
+template <typename RandomAccessIterator, typename BinaryPredicate>
+std::ptrdiff_t collect_keys(RandomAccessIterator begin,
+                            RandomAccessIterator end,
+                            std::ptrdiff_t wanted,
+                            BinaryPredicate compare)
+{
+    if (begin == end || wanted == 0) {
+        return 0;
+    }
+
+    // The keys found so far travel as a block, up to the entry being looked at
+    auto keys = begin;
+    std::ptrdiff_t n_keys = 1;
+    for (auto it = std::next(begin); it != end && n_keys < wanted; ++it) {
+        const auto keys_end = std::next(keys, n_keys);
+        const auto position = std::lower_bound(keys, keys_end, *it, compare);
+        if (position == keys_end || compare(*it, *position)) {
+            const auto offset = std::distance(keys, position);
+            keys = std::rotate(keys, keys_end, it);
+            std::rotate(std::next(keys, offset), it, std::next(it));
+            ++n_keys;
+        }
+    }
+    std::rotate(begin, keys, std::next(keys, n_keys));
+    return n_keys;
+}
+
+/// Working memory of a block merge: the scratch cache, an internal buffer of distinct keys, or none at all
+enum class block_buffer
+{
+    cache,
+    keys,
+    none
+};
+
+/**
+ * One step of a block merge: merges the sorted ranges [ @first , @middle ) and [ @middle , @last ) until either runs
+ * out. Ties go to the left range if @left_first, to the right one otherwise. What is left of the other range ends up
+ * at the end, [ returned iterator , @last ), and the returned flag tells whether it comes from the left range.
+ *
+ * - block_buffer::cache moves the left range, no longer than @cache's capacity, to @cache.
+ * - block_buffer::keys swaps entries with the @buffer_size keys just before @first, at least as many as there are
+ *   right entries. The buffer ends up just before the returned iterator, with its keys shuffled.
+ * - block_buffer::none rotates each run of left entries past the right entries that go before it, which moves the
+ *   left range once per distinct value in it.
+ */
+template <typename RandomAccessIterator, typename BinaryPredicate, typename Cache>
+std::pair<RandomAccessIterator, bool> block_merge_step(RandomAccessIterator first,
+                                                       RandomAccessIterator middle,
+                                                       RandomAccessIterator last,
+                                                       bool left_first,
+                                                       block_buffer buffer,
+                                                       std::ptrdiff_t buffer_size,
+                                                       BinaryPredicate& compare,
+                                                       Cache& cache)
+{
+    const auto right_goes_first = [&](const auto& right, const auto& left) {
+        return left_first ? compare(right, left) : !compare(left, right);
+    };
+
+    if (buffer == block_buffer::cache) {
+        cache.assign(std::move_iterator(first), std::move_iterator(middle));
+        auto left = cache.begin();
+        auto right = middle;
+        auto out = first;
+        while (left != cache.end() && right != last) {
+            const bool take_right = right_goes_first(*right, *left);
+            *out++ = std::move(take_right ? *right : *left);
+            right += take_right;
+            left += !take_right;
+        }
+        const bool left_remains = left != cache.end();
+        std::move(left, cache.end(), out);
+        cache.clear();
+        return {left_remains ? out : right, left_remains};
+    }
+
+    if (buffer == block_buffer::keys) {
+        auto out = std::prev(first, buffer_size);
+        auto left = first;
+        auto right = middle;
+        while (left != middle && right != last) {
+            std::iter_swap(out++, right_goes_first(*right, *left) ? right++ : left++);
+        }
+        if (left == middle) {
+            return {right, false};
+        }
+        // The buffer is split around what is left of the left range: bring it back together, in front of it
+        return {std::rotate(left, middle, last), true};
+    }
+
+    while (first != middle && middle != last) {
+        const auto cut = left_first ? std::lower_bound(middle, last, *first, compare)
+                                    : std::upper_bound(middle, last, *first, compare);
+        first = std::rotate(first, middle, cut);
+        middle = cut;
+        if (middle != last) {
+            first = left_first ? std::upper_bound(first, middle, *middle, compare)
+                               : std::lower_bound(first, middle, *middle, compare);
+        }
+    }
+    return first == middle ? std::pair{middle, false} : std::pair{first, true};
+}
+
+/**
+ * Stable merge of the sorted ranges A = [ @first , @middle ) and B = [ @middle , @last ), with O(1) working memory
+ * besides @buffer, in O(n) time for the buffers chosen by inplace_merge_sort.
+ *
+ * A is a whole number of blocks of @block_size entries, B a number of blocks followed by a shorter tail. Blocks are
+ * tagged with the sorted, distinct keys at @tags: A's take the lowest ones, so tags tell where a block comes from
+ * after they are moved, and in which order blocks of the same range were. A selection sort orders the blocks by their
+ * first entry, A before B on ties, and B's tail is rotated in after the last block that does not start after it.
+ * Every entry of a block then precedes the entries of later blocks from the other range, except for what is left of
+ * the previous blocks: that fragment is merged with each block from the other range, one block_merge_step at a time.
+ * The tags are sorted back at the end.
+ *
+ * With block_buffer::keys, the buffer keys sit just before @first, and the merged range ends up shifted to their place,
+ * with the buffer after it.
+ */
+template <typename RandomAccessIterator, typename BinaryPredicate, typename Cache>
+void block_merge(RandomAccessIterator tags,
+                 RandomAccessIterator first,
+                 RandomAccessIterator middle,
+                 RandomAccessIterator last,
+                 std::ptrdiff_t block_size,
+                 block_buffer buffer,
+                 BinaryPredicate& compare,
+                 Cache& cache)
+{
+    const auto a_blocks = std::distance(first, middle) / block_size;
+    const auto b_blocks = std::distance(middle, last) / block_size;
+    const auto n_blocks = a_blocks + b_blocks;
+    const auto blocks_end = std::next(first, n_blocks * block_size);
+    const auto tail_size = std::distance(blocks_end, last);
+    const auto block = [&](std::ptrdiff_t i) { return std::next(first, i * block_size); };
+
+    // Tags below the one at mid_tag, first of B's, belong to A blocks. Blocks of either range keep the order of their
+    // tags, so the next block is the remaining A or B one with the least tag, whichever starts lower
+    auto mid_tag = a_blocks;
+    for (std::ptrdiff_t i = 0; i < n_blocks && b_blocks != 0; ++i) {
+        auto least_a = n_blocks;
+        auto least_b = n_blocks;
+        for (auto j = i; j < n_blocks; ++j) {
+            auto& least = compare(tags[j], tags[mid_tag]) ? least_a : least_b;
+            if (least == n_blocks || compare(tags[j], tags[least])) {
+                least = j;
+            }
+        }
+        const auto next =
+          least_a == n_blocks || (least_b != n_blocks && compare(*block(least_b), *block(least_a))) ? least_b : least_a;
+        if (next != i) {
+            std::swap_ranges(block(i), block(i + 1), block(next));
+            std::iter_swap(std::next(tags, i), std::next(tags, next));
+            mid_tag = mid_tag == i ? next : mid_tag == next ? i : mid_tag;
+        }
+    }
+
+    auto tail_at = n_blocks;
+    if (tail_size != 0) {
+        while (tail_at > 0 && compare(*blocks_end, *block(tail_at - 1))) {
+            --tail_at;
+        }
+        std::rotate(block(tail_at), blocks_end, last);
+    }
+
+    auto fragment = first;
+    bool fragment_from_a = true;
+    auto piece = first;
+    std::ptrdiff_t tag = 0;
+    for (std::ptrdiff_t i = 0; i < n_blocks + (tail_size != 0); ++i) {
+        const bool is_tail = tail_size != 0 && i == tail_at;
+        const bool from_a = !is_tail && (b_blocks == 0 || compare(tags[tag], tags[mid_tag]));
+        const auto piece_end = std::next(piece, is_tail ? tail_size : block_size);
+        tag += !is_tail;
+
+        if (i == 0 || from_a == fragment_from_a) {
+            // The fragment goes before everything that is left to merge
+            if (buffer == block_buffer::keys && i != 0) {
+                std::rotate(std::prev(fragment, block_size), fragment, piece);
+            }
+            fragment = piece;
+            fragment_from_a = from_a;
+        } else {
+            const auto [rest, rest_from_fragment] =
+              block_merge_step(fragment, piece, piece_end, fragment_from_a, buffer, block_size, compare, cache);
+            fragment = rest;
+            fragment_from_a = rest_from_fragment ? fragment_from_a : from_a;
+        }
+        piece = piece_end;
+    }
+    if (buffer == block_buffer::keys) {
+        std::rotate(std::prev(fragment, block_size), fragment, last);
+    }
+
+    std::sort(tags, std::next(tags, n_blocks), compare);
+}
+
+/// Smallest power of two whose square is at least @width
+inline std::ptrdiff_t sqrt_block_size(std::ptrdiff_t width)
+{
+    std::ptrdiff_t block_size = 1;
+    while (block_size * block_size < width) {
+        block_size *= 2;
+    }
+    return block_size;
+}
+
+} // namespace internal
+
+/**
+ * Stable in-situ merge-sort using a small, fixed amount of working memory
+ * (AlgoConfig::INPLACE_MERGESORT_BUFFER_BYTES), regardless of the size of the range.
+ *
+ * Bottom-up: short runs are insertion-sorted, then merged pairwise with doubling widths. Runs that fit in the scratch
+ * cache are merged through it. Wider ones are block-merged (see internal::block_merge), WikiSort/GrailSort style:
+ * about 3 sqrt(n) distinct keys are first collected at the front of the range, to tag blocks and, once blocks
+ * outgrow the cache, to serve as the merge buffer. Keys are sorted and merged back at the end. Ranges with fewer
+ * distinct values make do with fewer, larger blocks merged by rotations, which few distinct values keep linear.
+ *
+ * Complexity: O(n log n) comparisons and moves.
+ */
+template <typename RandomAccessIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>>
+void inplace_merge_sort(RandomAccessIterator begin,
+                        RandomAccessIterator end,
+                        BinaryPredicate compare = BinaryPredicate{})
+{
+    static_assert(std::is_convertible<typename std::iterator_traits<RandomAccessIterator>::iterator_category,
+                                      std::random_access_iterator_tag>::value,
+                  "RandomAccessIterator must be random-access");
+
+    using value_type = typename std::iterator_traits<RandomAccessIterator>::value_type;
+    using internal::block_buffer;
+    constexpr std::ptrdiff_t run_size = 16;
+
+    std::vector<value_type> cache;
+    cache.reserve(std::max<std::size_t>(1, internal::AlgoConfig::INPLACE_MERGESORT_BUFFER_BYTES / sizeof(value_type)));
+    const auto capacity = static_cast<std::ptrdiff_t>(cache.capacity());
+    std::ptrdiff_t cache_block_size = 1;
+    while (2 * cache_block_size <= capacity) {
+        cache_block_size *= 2;
+    }
+
+    // Block size and buffer of the merges of runs of @width; the cache is used as long as its blocks are big enough
+    const auto block_plan = [&](std::ptrdiff_t width) {
+        return cache_block_size * cache_block_size >= width
+                 ? std::pair{cache_block_size, block_buffer::cache}
+                 : std::pair{internal::sqrt_block_size(width), block_buffer::keys};
+    };
+    const auto keys_needed = [&](std::ptrdiff_t width) {
+        const auto [block_size, buffer] = block_plan(width);
+        return 2 * width / block_size + (buffer == block_buffer::keys ? block_size : 0);
+    };
+
+    std::ptrdiff_t widest = run_size;
+    while (2 * widest < std::distance(begin, end)) {
+        widest *= 2;
+    }
+
+    std::ptrdiff_t n_keys = 0;
+    if (widest > capacity && widest < std::distance(begin, end)) {
+        n_keys = internal::collect_keys(begin, end, keys_needed(widest), compare);
+        if (n_keys < 2) {
+            return; // Entries are all equal
+        }
+    }
+    const auto data = std::next(begin, n_keys);
+    const auto size = std::distance(data, end);
+
+    for (std::ptrdiff_t lo = 0; lo < size; lo += run_size) {
+        internal::stable_insertion_sort_impl(
+          std::next(data, lo), std::next(data, std::min(lo + run_size, size)), compare);
+    }
+
+    for (std::ptrdiff_t width = run_size; width < size; width *= 2) {
+        auto [block_size, buffer] = block_plan(width);
+        if (width > capacity && keys_needed(width) > n_keys) {
+            // Too few distinct values for the planned buffer: as many blocks as there are keys, merged by rotations
+            buffer = block_buffer::none;
+            block_size = 1;
+            while (block_size * n_keys < 2 * width) {
+                block_size *= 2;
+            }
+        }
+        const auto shift = buffer == block_buffer::keys ? block_size : 0;
+
+        std::ptrdiff_t lo = 0;
+        for (; lo < size - width; lo += 2 * width) {
+            const auto first = std::next(data, lo);
+            const auto middle = std::next(first, width);
+            const auto last = std::next(data, std::min(lo + 2 * width, size));
+
+            if (!compare(*middle, *std::prev(middle))) {
+                std::rotate(std::prev(first, shift), first, last);
+            } else if (width <= capacity) {
+                internal::cache_merge(first, middle, last, compare, cache);
+            } else {
+                internal::block_merge(begin, first, middle, last, block_size, buffer, compare, cache);
+            }
+        }
+        // The keys buffer moved past every merged pair: back to the front
+        const auto merged_end = std::next(data, std::min(lo, size));
+        std::rotate(std::prev(data, shift), std::prev(merged_end, shift), merged_end);
+    }
+
+    if (n_keys != 0) {
+        std::sort(begin, data, compare);
+        if (n_keys <= capacity) {
+            internal::cache_merge(begin, data, end, compare, cache);
+        } else {
+            internal::block_merge_step(begin, data, end, true, block_buffer::none, 0, compare, cache);
+        }
+    }
+}
+
+namespace internal
+{
+
+/// Consecutive wins of one run after which merges switch to galloping mode
+inline constexpr std::ptrdiff_t TIMSORT_MIN_GALLOP = 7;
+
+/**
+ * Minimum length of the runs tim_sort builds with insertion sort: between 32 and 64, and such that @size divided by it
+ * is a power of two or slightly less, which keeps merges balanced.
+ */
+inline std::ptrdiff_t tim_sort_min_run(std::ptrdiff_t size)
+{
+    std::ptrdiff_t low_bits = 0;
+    while (size >= 64) {
+        low_bits |= size & 1;
+        size >>= 1;
+    }
+    return size + low_bits;
+}
+
+/**
+ * Finds the natural run that starts at @begin, and returns its end. Strictly descending runs are reversed in place;
+ * requiring strictness keeps the sort stable.
+ */
+template <typename RandomAccessIterator, typename BinaryPredicate>
+RandomAccessIterator tim_sort_run_end(RandomAccessIterator begin, RandomAccessIterator end, BinaryPredicate compare)
+{
+    auto run_end = std::next(begin);
+    if (run_end == end) {
+        return run_end;
+    }
+
+    if (compare(*run_end, *begin)) {
+        for (++run_end; run_end != end && compare(*run_end, *std::prev(run_end)); ++run_end) {
+        }
+        std::reverse(begin, run_end);
+    } else {
+        for (++run_end; run_end != end && !compare(*run_end, *std::prev(run_end)); ++run_end) {
+        }
+    }
+    return run_end;
+}
+
+/**
+ * Stable merge of the sorted ranges [ @first_begin , @first_end ) and [ @second_begin , @second_end ) into @out, where
+ * entries of the first range go first on ties. @out may overlap the second range, as long as it stays behind the
+ * entries of the second range not merged yet.
+ *
+ * Entries are merged one at a time until one of the ranges wins @min_gallop times in a row. The merge then switches to
+ * galloping mode, where runs of entries from either side are located with gallop_partition_point and moved at once,
+ * until galloping stops paying off. @min_gallop adapts: it gets lower while galloping pays, and higher otherwise.
+ */
+template <typename FirstIterator, typename SecondIterator, typename OutputIterator, typename BinaryPredicate>
+void gallop_merge_impl(FirstIterator first_begin,
+                       FirstIterator first_end,
+                       SecondIterator second_begin,
+                       SecondIterator second_end,
+                       OutputIterator out,
+                       BinaryPredicate compare,
+                       std::ptrdiff_t& min_gallop)
+{
+    auto first = first_begin;
+    auto second = second_begin;
+
+    while (first != first_end && second != second_end) {
+        std::ptrdiff_t first_wins = 0;
+        std::ptrdiff_t second_wins = 0;
+        while (first != first_end && second != second_end && first_wins < min_gallop && second_wins < min_gallop) {
+            if (compare(*second, *first)) {
+                *out++ = std::move(*second++);
+                ++second_wins;
+                first_wins = 0;
+            } else {
+                *out++ = std::move(*first++);
+                ++first_wins;
+                second_wins = 0;
+            }
+        }
+
+        while (first != first_end && second != second_end) {
+            const auto first_stop =
+              gallop_partition_point(first, first_end, [&](const auto& x) { return !compare(*second, x); });
+            const auto first_count = std::distance(first, first_stop);
+            out = std::move(first, first_stop, out);
+            first = first_stop;
+            if (first == first_end) {
+                break;
+            }
+
+            const auto second_stop =
+              gallop_partition_point(second, second_end, [&](const auto& x) { return compare(x, *first); });
+            const auto second_count = std::distance(second, second_stop);
+            out = std::move(second, second_stop, out);
+            second = second_stop;
+
+            if (first_count < TIMSORT_MIN_GALLOP && second_count < TIMSORT_MIN_GALLOP) {
+                ++min_gallop;
+                break;
+            }
+            min_gallop = std::max<std::ptrdiff_t>(1, min_gallop - 1);
+        }
+    }
+
+    // What is left of the second range is already in place
+    std::move(first, first_end, out);
+}
+
+/**
+ * Stable merge of the consecutive sorted runs [ @begin , @middle ) and [ @middle , @end ). Entries of either run that
+ * are already in their final place are skipped, and the shortest of what remains is moved to @buffer, then merged
+ * front to back or back to front.
+ */
+template <typename RandomAccessIterator, typename BinaryPredicate, typename Buffer>
+void tim_sort_merge(RandomAccessIterator begin,
+                    RandomAccessIterator middle,
+                    RandomAccessIterator end,
+                    BinaryPredicate compare,
+                    Buffer& buffer,
+                    std::ptrdiff_t& min_gallop)
+{
+    begin = gallop_partition_point(begin, middle, [&](const auto& x) { return !compare(*middle, x); });
+    if (begin == middle) {
+        return;
+    }
+    const auto& last_left = *std::prev(middle);
+    end = gallop_partition_point(std::reverse_iterator(end),
+                                 std::reverse_iterator(middle),
+                                 [&](const auto& x) { return !compare(x, last_left); })
+            .base();
+
+    if (std::distance(begin, middle) <= std::distance(middle, end)) {
+        buffer.assign(std::move_iterator(begin), std::move_iterator(middle));
+        gallop_merge_impl(buffer.begin(), buffer.end(), middle, end, begin, compare, min_gallop);
+    } else {
+        buffer.assign(std::move_iterator(middle), std::move_iterator(end));
+        const auto reversed = [&](const auto& x, const auto& y) { return compare(y, x); };
+        gallop_merge_impl(buffer.rbegin(),
+                          buffer.rend(),
+                          std::reverse_iterator(middle),
+                          std::reverse_iterator(begin),
+                          std::reverse_iterator(end),
+                          reversed,
+                          min_gallop);
+    }
+    buffer.clear();
+}
+
+} // namespace internal
+
+/**
+ * Adaptive, stable in-situ sort for random access ranges (TimSort).
+ *
+ * The range is scanned for natural runs: non-descending runs are kept, strictly descending ones are reversed, and runs
+ * shorter than 32 to 64 entries are extended with binary insertion sort. Runs are pushed on a stack and merged while
+ * the lengths of the three topmost do not shrink fast enough, which keeps merges balanced. Merges skip the entries
+ * already in place and switch to galloping when one run keeps winning.
+ *
+ * Complexity: O(n log n) in the worst case, O(n) on presorted, reversed or concatenated sorted inputs. Allocates a
+ * buffer of up to n / 2 entries.
+ */
+template <typename RandomAccessIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>>
+void tim_sort(RandomAccessIterator begin, RandomAccessIterator end, BinaryPredicate compare = BinaryPredicate{})
+{
+    static_assert(std::is_convertible<typename std::iterator_traits<RandomAccessIterator>::iterator_category,
+                                      std::random_access_iterator_tag>::value,
+                  "RandomAccessIterator must be random-access");
+
+    using value_type = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+    const auto size = std::distance(begin, end);
+    if (size < 2) {
+        return;
+    }
+    const auto min_run = internal::tim_sort_min_run(size);
+
+    std::vector<std::pair<std::ptrdiff_t, std::ptrdiff_t>> runs; // Offset and length of every pending run
+    std::vector<value_type> buffer;
+    std::ptrdiff_t min_gallop = internal::TIMSORT_MIN_GALLOP;
+
+    const auto merge_at = [&](std::size_t i) {
+        const auto [offset, length] = runs[i];
+        const auto next_length = runs[i + 1].second;
+        internal::tim_sort_merge(std::next(begin, offset),
+                                 std::next(begin, offset + length),
+                                 std::next(begin, offset + length + next_length),
+                                 compare,
+                                 buffer,
+                                 min_gallop);
+        runs[i].second += next_length;
+        runs.erase(runs.begin() + i + 1);
+    };
+
+    for (std::ptrdiff_t offset = 0; offset < size;) {
+        const auto run_begin = std::next(begin, offset);
+        auto run_end = internal::tim_sort_run_end(run_begin, end, compare);
+
+        // Binary insertion sort up to the minimum run length
+        const auto forced_end = std::next(run_begin, std::min(min_run, size - offset));
+        for (; run_end < forced_end; ++run_end) {
+            auto position = std::upper_bound(run_begin, run_end, *run_end, compare);
+            std::rotate(position, run_end, std::next(run_end));
+        }
+
+        const auto length = std::distance(run_begin, run_end);
+        runs.emplace_back(offset, length);
+        offset += length;
+
+        // Run lengths must keep A > B + C and B > C from the bottom to the top C of the stack
+        while (runs.size() > 1) {
+            auto n = runs.size() - 2;
+            if ((n > 0 && runs[n - 1].second <= runs[n].second + runs[n + 1].second) ||
+                (n > 1 && runs[n - 2].second <= runs[n - 1].second + runs[n].second)) {
+                if (runs[n - 1].second < runs[n + 1].second) {
+                    --n;
+                }
+            } else if (runs[n].second > runs[n + 1].second) {
+                break;
+            }
+            merge_at(n);
+        }
+    }
+
+    while (runs.size() > 1) {
+        auto n = runs.size() - 2;
+        if (n > 0 && runs[n - 1].second < runs[n + 1].second) {
+            --n;
+        }
+        merge_at(n);
+    }
+}
+
+namespace internal
+{
+
+/// Moves the first node of @src to the front of @dst, without copying the element.
+template <typename T, typename Allocator>
+void splice_front(std::list<T, Allocator>& dst, std::list<T, Allocator>& src)
+{
+    dst.splice(dst.begin(), src, src.begin());
+}
+
+template <typename T, typename Allocator>
+void splice_front(std::forward_list<T, Allocator>& dst, std::forward_list<T, Allocator>& src)
+{
+    dst.splice_after(dst.before_begin(), src, src.before_begin());
+}
+
+/// Stable merge of sorted list @from into sorted list @into, by re-linking nodes. On ties, nodes of @into go first.
+template <typename T, typename Allocator, typename BinaryPredicate>
+void splice_merge(std::list<T, Allocator>& into, std::list<T, Allocator>& from, BinaryPredicate compare)
+{
+    auto it = into.begin();
+    while (!from.empty()) {
+        it = std::find_if(it, into.end(), [&](const auto& x) { return compare(from.front(), x); });
+        if (it == into.end()) {
+            into.splice(it, from);
+            return;
+        }
+        // Move the whole run of @from that precedes *it
+        auto run_end =
+          std::find_if_not(std::next(from.begin()), from.end(), [&](const auto& x) { return compare(x, *it); });
+        into.splice(it, from, from.begin(), run_end);
+    }
+}
+
+template <typename T, typename Allocator, typename BinaryPredicate>
+void splice_merge(std::forward_list<T, Allocator>& into,
+                  std::forward_list<T, Allocator>& from,
+                  BinaryPredicate compare)
+{
+    auto prev = into.before_begin();
+    while (!from.empty()) {
+        while (std::next(prev) != into.end() && !compare(from.front(), *std::next(prev))) {
+            ++prev;
+        }
+        if (std::next(prev) == into.end()) {
+            into.splice_after(prev, from);
+            return;
+        }
+        // Move the whole run of @from that precedes the next node of @into
+        const auto& next = *std::next(prev);
+        auto run_last = from.begin();
+        while (std::next(run_last) != from.end() && compare(*std::next(run_last), next)) {
+            ++run_last;
+        }
+        into.splice_after(prev, from, from.before_begin(), std::next(run_last));
+        prev = run_last;
+    }
+}
+
+/**
+ * Bottom-up merge-sort of a linked list. Nodes are re-linked: no element is copied and no memory is allocated.
+ *
+ * Bin i holds a sorted list of 2^i nodes. Nodes are taken one at a time and carried up through the bins like a binary
+ * counter, merging with every full bin on the way.
+ */
+template <typename List, typename BinaryPredicate>
+void list_merge_sort_impl(List& list, BinaryPredicate compare)
+{
+    List carry;
+    std::array<List, std::numeric_limits<std::size_t>::digits> bins;
+    std::size_t n_bins = 0;
+
+    while (!list.empty()) {
+        splice_front(carry, list);
+
+        std::size_t i = 0;
+        for (; i < n_bins && !bins[i].empty(); ++i) {
+            splice_merge(bins[i], carry, compare);
+            carry.swap(bins[i]);
+        }
+        carry.swap(bins[i]);
+        n_bins = std::max(n_bins, i + 1);
+    }
+
+    for (std::size_t i = 1; i < n_bins; ++i) {
+        splice_merge(bins[i], bins[i - 1], compare);
+    }
+    if (n_bins != 0) {
+        list.swap(bins[n_bins - 1]);
+    }
+}
+
+}
+
+/// Stable in-situ merge-sort of a std::list. Only node links are modified.
+template <typename T, typename Allocator, typename BinaryPredicate = std::less<T>>
+void merge_sort(std::list<T, Allocator>& list, BinaryPredicate compare = BinaryPredicate{})
+{
+    internal::list_merge_sort_impl(list, compare);
+}
+
+/// Stable in-situ merge-sort of a std::forward_list. Only node links are modified.
+template <typename T, typename Allocator, typename BinaryPredicate = std::less<T>>
+void merge_sort(std::forward_list<T, Allocator>& list, BinaryPredicate compare = BinaryPredicate{})
+{
+    internal::list_merge_sort_impl(list, compare);
+}
+
+/// In-situ merge-sort + inversion count
+template <typename InputIterator,
+          typename OutputIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<InputIterator>::value_type>>
+std::size_t sort_and_count_inversions(InputIterator begin,
+                                      InputIterator end,
+                                      OutputIterator out_begin,
+                                      BinaryPredicate compare = BinaryPredicate{})
+{
+    static_assert(std::is_convertible<typename std::iterator_traits<InputIterator>::iterator_category,
+                                      std::bidirectional_iterator_tag>::value,
+                  "InputIterator must be bidirectional");
+
+    std::size_t swaps = 0;
+    internal::merge_sort_impl<InputIterator, OutputIterator, BinaryPredicate, std::size_t>(
+      begin, end, out_begin, compare, &swaps);
+    return swaps;
+}
+
+#if defined(__SIZEOF_INT128__)
+/// Wide enough for the number of inversions of any range that fits in memory
+__extension__ typedef unsigned __int128 inversion_count_t;
+#else
+typedef std::uintmax_t inversion_count_t;
+#endif
+
+namespace internal
+{
+
+/**
+ * Stable merge of the sorted ranges [ @left , @left_end ) and [ @right , @right_end ) into @out. Returns the number
+ * of inversions between them: the pairs of a left and a right entry where the right one is less than the left one.
+ */
+template <typename Counter, typename InputIterator, typename OutputIterator, typename BinaryPredicate>
+Counter count_merge_impl(InputIterator left,
+                         InputIterator left_end,
+                         InputIterator right,
+                         InputIterator right_end,
+                         OutputIterator out,
+                         BinaryPredicate compare)
+{
+    Counter count = 0;
+    auto left_remaining = std::distance(left, left_end);
+
+    while (left != left_end && right != right_end) {
+        if (compare(*right, *left)) {
+            count += static_cast<Counter>(left_remaining);
+            *out++ = std::move(*right++);
+        } else {
+            --left_remaining;
+            *out++ = std::move(*left++);
+        }
+    }
+    std::move(right, right_end, std::move(left, left_end, out));
+    return count;
+}
+
+/// Insertion sort of [ @begin , @end ), returning the number of inversions it undid
+template <typename Counter, typename RandomAccessIterator, typename BinaryPredicate>
+Counter count_insertion_sort_impl(RandomAccessIterator begin, RandomAccessIterator end, BinaryPredicate compare)
+{
+    Counter count = 0;
+    for (auto it = begin; it != end; ++it) {
+        auto value = std::move(*it);
+        auto hole = it;
+        for (; hole != begin && compare(value, *std::prev(hole)); --hole) {
+            *hole = std::move(*std::prev(hole));
+        }
+        count += static_cast<Counter>(std::distance(hole, it));
+        *hole = std::move(value);
+    }
+    return count;
+}
+
+/// Merges every pair of adjacent sorted runs of @width entries of @from into @to, returning the inversions between them
+template <typename Counter, typename FromIterator, typename ToIterator, typename BinaryPredicate>
+Counter count_merge_pass(
+  FromIterator from, ToIterator to, std::ptrdiff_t size, std::ptrdiff_t width, BinaryPredicate compare)
+{
+    Counter count = 0;
+    for (std::ptrdiff_t lo = 0; lo < size; lo += 2 * width) {
+        const auto middle = std::min(lo + width, size);
+        const auto hi = std::min(lo + 2 * width, size);
+        count += count_merge_impl<Counter>(from + lo, from + middle, from + middle, from + hi, to + lo, compare);
+    }
+    return count;
+}
+
+/**
+ * Counts the inversions of the @size entries starting at @data while sorting them, using the range starting at
+ * @scratch as the only working memory. Bottom-up: short runs are insertion-sorted, then merged back and forth between
+ * both buffers. The sorted entries end up in @data.
+ */
+template <typename Counter, typename RandomAccessIterator, typename ScratchIterator, typename BinaryPredicate>
+Counter count_inversions_merge(RandomAccessIterator data,
+                               ScratchIterator scratch,
+                               std::ptrdiff_t size,
+                               BinaryPredicate compare)
+{
+    constexpr std::ptrdiff_t run_size = 32;
+
+    Counter count = 0;
+    for (std::ptrdiff_t lo = 0; lo < size; lo += run_size) {
+        count += count_insertion_sort_impl<Counter>(data + lo, data + std::min(lo + run_size, size), compare);
+    }
+
+    bool sorted_in_data = true;
+    for (std::ptrdiff_t width = run_size; width < size; width *= 2) {
+        count += sorted_in_data ? count_merge_pass<Counter>(data, scratch, size, width, compare)
+                                : count_merge_pass<Counter>(scratch, data, size, width, compare);
+        sorted_in_data = !sorted_in_data;
+    }
+    if (!sorted_in_data) {
+        std::move(scratch, scratch + size, data);
+    }
+    return count;
+}
+
+/**
+ * Counts inversions with a Fenwick tree over the @domain_size keys of the integers in [ @begin , @end ), the least
+ * being @min_key: for every entry, the entries seen before it that are greater. O(n log k) for k keys, without sorting.
+ */
+template <typename Counter, typename ForwardIterator, typename Integer, typename BinaryPredicate>
+Counter count_inversions_fenwick(ForwardIterator begin,
+                                 ForwardIterator end,
+                                 Integer min_key,
+                                 std::size_t domain_size,
+                                 BinaryPredicate)
+{
+    constexpr bool ascending =
+      std::is_same_v<BinaryPredicate, std::less<Integer>> || std::is_same_v<BinaryPredicate, std::less<>>;
+
+    std::vector<std::uint64_t> tree(domain_size + 1);
+    std::uint64_t seen = 0;
+    Counter count = 0;
+    for (; begin != end; ++begin, ++seen) {
+        // Descending orders count greater entries as lesser ones, by flipping keys
+        using unsigned_type = std::make_unsigned_t<Integer>;
+        auto key = static_cast<std::size_t>(static_cast<unsigned_type>(static_cast<unsigned_type>(*begin) - min_key));
+        if constexpr (!ascending) {
+            key = domain_size - 1 - key;
+        }
+
+        std::uint64_t not_greater = 0;
+        for (auto node = key + 1; node > 0; node &= node - 1) {
+            not_greater += tree[node];
+        }
+        count += static_cast<Counter>(seen - not_greater);
+
+        for (auto node = key + 1; node <= domain_size; node += node & (~node + 1)) {
+            ++tree[node];
+        }
+    }
+    return count;
+}
+
+/**
+ * Counting counterpart of parallel_merge_impl. Every task merges its merge-path slice and counts the inversions of the
+ * right entries it takes: the left entries of its slice still to come, plus all the left entries past the slice,
+ * which every right entry of the slice precedes. Per-task counts are summed at the end.
+ */
+template <typename Counter,
+          typename LRandomAccessIterator,
+          typename RRandomAccessIterator,
+          typename RandomAccessOutputIterator,
+          typename BinaryPredicate>
+Counter parallel_count_merge_impl(LRandomAccessIterator left_begin,
+                                  LRandomAccessIterator left_end,
+                                  RRandomAccessIterator right_begin,
+                                  RRandomAccessIterator right_end,
+                                  RandomAccessOutputIterator out_begin,
+                                  BinaryPredicate compare,
+                                  unsigned n_tasks)
+{
+    const auto left_size = std::distance(left_begin, left_end);
+    const auto right_size = std::distance(right_begin, right_end);
+    const auto size = left_size + right_size;
+    const auto slice = (size + n_tasks - 1) / n_tasks;
+
+    std::vector<Counter> counts(n_tasks, 0);
+    parallel_for(n_tasks, [&](unsigned task) {
+        const auto first_diagonal = std::min<std::ptrdiff_t>(size, task * slice);
+        const auto last_diagonal = std::min(size, first_diagonal + slice);
+        const auto l0 = merge_path_split(left_begin, left_size, right_begin, right_size, first_diagonal, compare);
+        const auto l1 = merge_path_split(left_begin, left_size, right_begin, right_size, last_diagonal, compare);
+        const auto right_taken = (last_diagonal - l1) - (first_diagonal - l0);
+
+        counts[task] = count_merge_impl<Counter>(std::move_iterator(std::next(left_begin, l0)),
+                                                 std::move_iterator(std::next(left_begin, l1)),
+                                                 std::move_iterator(std::next(right_begin, first_diagonal - l0)),
+                                                 std::move_iterator(std::next(right_begin, last_diagonal - l1)),
+                                                 std::next(out_begin, first_diagonal),
+                                                 compare) +
+                       static_cast<Counter>(right_taken) * static_cast<Counter>(left_size - l1);
+    });
+    return std::accumulate(counts.cbegin(), counts.cend(), Counter{0});
+}
+
+template <typename Counter, typename SortIterator, typename ScratchIterator, typename BinaryPredicate>
+Counter parallel_count_sort_to(SortIterator begin,
+                               std::ptrdiff_t size,
+                               ScratchIterator scratch,
+                               BinaryPredicate compare,
+                               unsigned n_tasks);
+
+/// Counting counterpart of parallel_merge_sort_in_place: returns the inversions of the range it sorts
+template <typename Counter, typename SortIterator, typename ScratchIterator, typename BinaryPredicate>
+Counter parallel_count_sort_in_place(SortIterator begin,
+                                     std::ptrdiff_t size,
+                                     ScratchIterator scratch,
+                                     BinaryPredicate compare,
+                                     unsigned n_tasks)
+{
+    if (n_tasks < 2 || size < AlgoConfig::PARALLEL_MIN_SIZE) {
+        return count_inversions_merge<Counter>(begin, scratch, size, compare);
+    }
+
+    const auto half = size / 2;
+    auto middle = std::next(begin, half);
+    auto scratch_middle = std::next(scratch, half);
+
+    Counter left_count = 0;
+    Counter right_count = 0;
+    fork_join(
+      [&] { left_count = parallel_count_sort_to<Counter>(begin, half, scratch, compare, n_tasks / 2); },
+      [&] {
+          right_count =
+            parallel_count_sort_to<Counter>(middle, size - half, scratch_middle, compare, n_tasks - n_tasks / 2);
+      });
+
+    return left_count + right_count +
+           parallel_count_merge_impl<Counter>(
+             scratch, scratch_middle, scratch_middle, std::next(scratch_middle, size - half), begin, compare, n_tasks);
+}
+
+/// Counting counterpart of parallel_merge_sort_to: returns the inversions of the range it sorts into @scratch
+template <typename Counter, typename SortIterator, typename ScratchIterator, typename BinaryPredicate>
+Counter parallel_count_sort_to(SortIterator begin,
+                               std::ptrdiff_t size,
+                               ScratchIterator scratch,
+                               BinaryPredicate compare,
+                               unsigned n_tasks)
+{
+    if (n_tasks < 2 || size < AlgoConfig::PARALLEL_MIN_SIZE) {
+        const auto count = count_inversions_merge<Counter>(begin, scratch, size, compare);
+        std::move(begin, std::next(begin, size), scratch);
+        return count;
+    }
+
+    const auto half = size / 2;
+    auto middle = std::next(begin, half);
+    auto scratch_middle = std::next(scratch, half);
+
+    Counter left_count = 0;
+    Counter right_count = 0;
+    fork_join(
+      [&] { left_count = parallel_count_sort_in_place<Counter>(begin, half, scratch, compare, n_tasks / 2); },
+      [&] {
+          right_count = parallel_count_sort_in_place<Counter>(
+            middle, size - half, scratch_middle, compare, n_tasks - n_tasks / 2);
+      });
+
+    return left_count + right_count +
+           parallel_count_merge_impl<Counter>(
+             begin, middle, middle, std::next(middle, size - half), scratch, compare, n_tasks);
+}
+
+} // namespace internal
+
+/**
+ * Number of inversions of [ @begin , @end ): pairs of entries where the later one is less than the earlier one,
+ * according to @compare. Equal entries are not inversions. The input is only read.
+ *
+ * Integers ordered by std::less or std::greater, whose keys span a domain much smaller than the range, are counted
+ * with a Fenwick tree. Other inputs are copied once and counted by a bottom-up merge-sort with a single scratch
+ * buffer. Counts accumulate into @Counter, 128 bits wide by default.
+ *
+ * Complexity: O(n log n), or O(n log k) for k distinct integer keys.
+ */
+template <typename Counter = inversion_count_t,
+          typename ForwardIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<ForwardIterator>::value_type>>
+Counter count_inversions(ForwardIterator begin, ForwardIterator end, BinaryPredicate compare = BinaryPredicate{})
+{
+    using value_type = typename std::iterator_traits<ForwardIterator>::value_type;
+
+    if constexpr (std::is_integral_v<value_type> && internal::is_builtin_order_v<value_type, BinaryPredicate>) {
+        constexpr std::size_t max_domain_size = std::size_t{1} << 22;
+
+        if (begin != end) {
+            using unsigned_type = std::make_unsigned_t<value_type>;
+            const auto [min_it, max_it] = std::minmax_element(begin, end);
+            const auto span = static_cast<unsigned_type>(static_cast<unsigned_type>(*max_it) - *min_it);
+            const auto size = static_cast<std::size_t>(std::distance(begin, end));
+            if (span < max_domain_size && span < size) {
+                const auto domain_size = static_cast<std::size_t>(span) + 1;
+                return internal::count_inversions_fenwick<Counter>(begin, end, *min_it, domain_size, compare);
+            }
+        }
+    }
+
+    std::vector<value_type> data(begin, end);
+    std::vector<value_type> scratch(data.size());
+    return internal::count_inversions_merge<Counter>(
+      data.begin(), scratch.begin(), static_cast<std::ptrdiff_t>(data.size()), compare);
+}
+
+/**
+ * Inversion count with an execution policy. Parallel policies count both halves concurrently, and split every merge
+ * among threads with merge-path partitioning: each thread counts the inversions of the right entries in its slice of
+ * the output. The count is the same as the sequential count_inversions. std::execution::seq falls back to it.
+ */
+template <typename Counter = inversion_count_t,
+          typename ExecutionPolicy,
+          typename RandomAccessIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>>
+std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>, Counter> count_inversions(
+  ExecutionPolicy&&,
+  RandomAccessIterator begin,
+  RandomAccessIterator end,
+  BinaryPredicate compare = BinaryPredicate{})
+{
+    if constexpr (!internal::is_parallel_policy<ExecutionPolicy>()) {
+        return count_inversions<Counter>(begin, end, compare);
+    } else {
+        using value_type = typename std::iterator_traits<RandomAccessIterator>::value_type;
+        std::vector<value_type> data(begin, end);
+        std::vector<value_type> scratch(data.size());
+
+        return internal::parallel_count_sort_in_place<Counter>(data.begin(),
+                                                               static_cast<std::ptrdiff_t>(data.size()),
+                                                               scratch.begin(),
+                                                               compare,
+                                                               internal::AlgoConfig::PARALLEL_TASKS);
+    }
+}
+
+/**
+ * sort_and_count_inversions with an execution policy. Parallel policies sort and count as count_inversions does, with
+ * the sorted entries written to @out_begin. std::execution::seq falls back to the sequential sort_and_count_inversions.
+ */
+template <typename ExecutionPolicy,
+          typename RandomAccessIterator,
+          typename RandomAccessOutputIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>>
+std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>, std::size_t> sort_and_count_inversions(
+  ExecutionPolicy&&,
+  RandomAccessIterator begin,
+  RandomAccessIterator end,
+  RandomAccessOutputIterator out_begin,
+  BinaryPredicate compare = BinaryPredicate{})
+{
+    if constexpr (!internal::is_parallel_policy<ExecutionPolicy>()) {
+        return sort_and_count_inversions(begin, end, out_begin, compare);
+    } else {
+        static_assert(std::is_convertible<typename std::iterator_traits<RandomAccessOutputIterator>::iterator_category,
+                                          std::random_access_iterator_tag>::value,
+                      "RandomAccessOutputIterator must be random-access");
+
+        using value_type = typename std::iterator_traits<RandomAccessIterator>::value_type;
+        std::vector<value_type> buffer(begin, end);
+
+        return internal::parallel_count_sort_to<std::size_t>(buffer.begin(),
+                                                             static_cast<std::ptrdiff_t>(buffer.size()),
+                                                             out_begin,
+                                                             compare,
+                                                             internal::AlgoConfig::PARALLEL_TASKS);
+    }
+}
+
+namespace internal
+{
+
+/// SplitMix64 generator: eight bytes of state and a handful of instructions per draw, plenty to pick pivots.
+class splitmix64
+{
+  public:
+    explicit splitmix64(std::uint64_t seed) noexcept : state_(seed)
+    {
+    }
+
+    std::uint64_t operator()() noexcept
+    {
+        std::uint64_t z = (state_ += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+  private:
+    std::uint64_t state_;
+};
+
+/// Per-thread generator used for random pivots. Seeded once per thread from std::random_device.
+inline splitmix64& pivot_rng()
+{
+    thread_local splitmix64 rng{std::random_device{}()};
+    return rng;
+}
+
+/// Points the calling thread's pivot generator at @seed until the end of the scope, so that a task of a parallel sort
+/// draws the same pivots whichever thread runs it.
+class scoped_pivot_seed
+{
+  public:
+    explicit scoped_pivot_seed(std::uint64_t seed)
+      : previous_(std::exchange(pivot_rng(), splitmix64{seed}))
+    {
+    }
+
+    scoped_pivot_seed(const scoped_pivot_seed&) = delete;
+    scoped_pivot_seed& operator=(const scoped_pivot_seed&) = delete;
+
+    ~scoped_pivot_seed()
+    {
+        pivot_rng() = previous_;
+    }
+
+  private:
+    splitmix64 previous_;
+};
+
+/// Returns whichever of the three iterators points to the median value.
+template <typename ForwardIterator, typename BinaryPredicate>
+ForwardIterator median_of_3(ForwardIterator a, ForwardIterator b, ForwardIterator c, BinaryPredicate& compare)
+{
+    if (compare(*b, *a)) {
+        std::swap(a, b);
+    }
+    if (compare(*c, *b)) {
+        return compare(*c, *a) ? a : c;
+    }
+    return b;
+}
+
+template <typename PivotPolicy, typename ForwardIterator, typename BinaryPredicate>
+ForwardIterator select_impl(ForwardIterator begin, ForwardIterator end, std::ptrdiff_t n, BinaryPredicate& compare);
+
+} // namespace internal
+
+/**
+ * Pivot selection policies for quick_sort, intro_sort and nth_element.
+ *
+ * Every policy exposes `choose(begin, end, compare)`, which returns an iterator to the pivot in the non-empty range
+ * [begin, end). The strategy is resolved at compile time; `runtime` keeps the old behaviour of reading
+ * AlgoConfig::QUICKSORT_PIVOT_CHOICE on every call.
+ */
+namespace pivot
+{
+
+struct first
+{
+    template <typename ForwardIterator, typename BinaryPredicate>
+    static ForwardIterator choose(ForwardIterator begin, [[maybe_unused]] ForwardIterator end, BinaryPredicate&)
+    {
+        assert(begin != end);
+        return begin;
+    }
+};
+
+struct last
+{
+    template <typename ForwardIterator, typename BinaryPredicate>
+    static ForwardIterator choose(ForwardIterator begin, ForwardIterator end, BinaryPredicate&)
+    {
+        assert(begin != end);
+        return std::next(begin, std::distance(begin, end) - 1);
+    }
+};
+
+/// Median of the first, middle and last entries
+struct sample_3
+{
+    template <typename ForwardIterator, typename BinaryPredicate>
+    static ForwardIterator choose(ForwardIterator begin, ForwardIterator end, BinaryPredicate& compare)
+    {
+        assert(begin != end);
+
+        const auto size = std::distance(begin, end);
+        const auto midpoint = (size - 1) / 2;
 
-        auto& ptr = comp ? left : right;
-        *it = *ptr;
-        std::advance(ptr, 1);
-        std::advance(it, 1);
-    }
+        auto midpoint_it = std::next(begin, midpoint);
+        auto last_it = std::next(midpoint_it, size - midpoint - 1);
+        std::array<ForwardIterator, 3> arr{begin, midpoint_it, last_it};
 
-    if (right == right_end) {
-        return std::copy(left, left_end, it);
+        auto iter_comp = [&](const auto& it1, const auto& it2) { return compare(*it1, *it2); };
+        internal::non_recursive_sort<typename std::array<ForwardIterator, 3>::iterator, decltype(iter_comp), void>(
+          arr.begin(), arr.end(), iter_comp, nullptr);
+        return arr[1];
     }
-    return std::copy(right, right_end, it);
-}
+};
 
-/// Merge-sort
-template <typename InputIterator, typename OutputIterator, typename BinaryPredicate, typename SwapCounter>
-OutputIterator merge_sort_impl(InputIterator begin,
-                               InputIterator end,
-                               OutputIterator out_begin,
-                               BinaryPredicate compare,
-                               SwapCounter* swaps)
+/// Uniformly random entry. The generator is thread-local: call seed() for reproducible runs.
+struct random
 {
-    const auto size = std::distance(begin, end);
-
-    if (size < AlgoConfig::MERGESORT_MIN_SIZE) {
-        auto out_end = std::copy(begin, end, out_begin);
-        non_recursive_sort<OutputIterator, BinaryPredicate, SwapCounter>(out_begin, out_end, compare, swaps);
-        return out_end;
+    /// Seeds the calling thread's generator. Parallel sorts started from this thread draw the seeds of their tasks
+    /// from it, so they are reproducible too.
+    static void seed(std::uint64_t seed)
+    {
+        internal::pivot_rng() = internal::splitmix64{seed};
     }
 
-    auto middle = std::next(begin, size / 2);
+    template <typename ForwardIterator, typename BinaryPredicate>
+    static ForwardIterator choose(ForwardIterator begin, ForwardIterator end, BinaryPredicate&)
+    {
+        assert(begin != end);
 
-    auto intermediate_container = std::vector(begin, end);
-    auto int_begin = intermediate_container.begin();
-    auto int_middle = std::next(int_begin, size / 2);
-    auto int_end = intermediate_container.end();
+        const auto size = static_cast<std::uint64_t>(std::distance(begin, end));
+        return std::next(begin, internal::pivot_rng()() % size);
+    }
+};
 
-    merge_sort_impl<InputIterator, decltype(int_begin), BinaryPredicate, SwapCounter>(
-      begin, middle, int_begin, compare, swaps);
-    merge_sort_impl<InputIterator, decltype(int_begin), BinaryPredicate, SwapCounter>(
-      middle, end, int_middle, compare, swaps);
+/// Tukey's ninther: median of the medians of three evenly spaced triplets
+struct ninther
+{
+    template <typename ForwardIterator, typename BinaryPredicate>
+    static ForwardIterator choose(ForwardIterator begin, ForwardIterator end, BinaryPredicate& compare)
+    {
+        const auto size = std::distance(begin, end);
+        if (size < 9) {
+            return sample_3::choose(begin, end, compare);
+        }
 
-    // Merging
-    return my::internal::merge_impl(std::move_iterator(int_begin),
-                                    std::move_iterator(int_middle),
-                                    std::move_iterator(int_middle),
-                                    std::move_iterator(int_end),
-                                    out_begin,
-                                    compare,
-                                    swaps);
-}
+        std::array<ForwardIterator, 9> samples;
+        samples[0] = begin;
+        for (std::size_t i = 1; i < samples.size(); ++i) {
+            samples[i] = std::next(samples[i - 1], (i * (size - 1)) / 8 - ((i - 1) * (size - 1)) / 8);
+        }
 
-}
+        return internal::median_of_3(internal::median_of_3(samples[0], samples[1], samples[2], compare),
+                                     internal::median_of_3(samples[3], samples[4], samples[5], compare),
+                                     internal::median_of_3(samples[6], samples[7], samples[8], compare),
+                                     compare);
+    }
+};
 
-/** Splits the array into two parts. The first part is composed of all entries that
- * fulfil the predicate. Those that don't, are moved to the second part. The first
- * item of the second part is returned.
+/**
+ * Blum-Floyd-Pratt-Rivest-Tarjan median of medians. The median of every group of five entries is moved to the front
+ * of the range, and their exact median is selected recursively. The pivot is guaranteed to lie between the 30th and
+ * 70th percentiles, which makes selection linear in the worst case.
+ *
+ * Note that this policy reorders the range.
  */
+struct median_of_medians
+{
+    template <typename ForwardIterator, typename BinaryPredicate>
+    static ForwardIterator choose(ForwardIterator begin, ForwardIterator end, BinaryPredicate& compare)
+    {
+        assert(begin != end);
+
+        auto medians_end = begin;
+        for (auto group = begin; group != end;) {
+            auto group_end = group;
+            std::ptrdiff_t group_size = 0;
+            for (; group_size < 5 && group_end != end; ++group_size) {
+                ++group_end;
+            }
+
+            internal::selection_sort_impl(group, group_end, compare);
+            std::iter_swap(medians_end++, std::next(group, (group_size - 1) / 2));
+            group = group_end;
+        }
 
-template <typename Iterator, typename UnaryPredicate>
-Iterator partition(Iterator begin, Iterator end, UnaryPredicate pred)
+        const auto n_medians = std::distance(begin, medians_end);
+        if (n_medians == 1) {
+            return begin;
+        }
+        return internal::select_impl<median_of_medians>(begin, medians_end, (n_medians - 1) / 2, compare);
+    }
+};
+
+/**
+ * Floyd-Rivest sampling. To select the entry of rank n, a random sample of about size^(2/3) entries is gathered around
+ * position n, and reordered so that its own entry of the corresponding rank lands at position n, which becomes the
+ * pivot. With high probability, partitioning around it leaves only a small range around n to select from.
+ * As a quick_sort or intro_sort pivot, it is an estimate of the median.
+ *
+ * Note that this policy reorders the range, and is meant for random access ranges.
+ */
+struct floyd_rivest
 {
-    if (begin == end) {
-        return begin;
+    template <typename ForwardIterator, typename BinaryPredicate>
+    static ForwardIterator choose(ForwardIterator begin, ForwardIterator end, BinaryPredicate& compare)
+    {
+        return choose(begin, end, (std::distance(begin, end) - 1) / 2, compare);
     }
-    auto partition_point = begin;
-    for (; begin != end; std::advance(begin, 1)) {
-        if (pred(*begin)) {
-            std::iter_swap(partition_point, begin);
-            std::advance(partition_point, 1);
+
+    /// Pivot for selecting the entry of rank @n
+    template <typename ForwardIterator, typename BinaryPredicate>
+    static ForwardIterator choose(ForwardIterator begin,
+                                  ForwardIterator end,
+                                  std::ptrdiff_t n,
+                                  BinaryPredicate& compare)
+    {
+        assert(n < std::distance(begin, end));
+
+        const auto size = std::distance(begin, end);
+        if (size < 600) {
+            return ninther::choose(begin, end, compare);
         }
+
+        const double log_size = std::log(static_cast<double>(size));
+        const double sample_size = 0.5 * std::exp(2 * log_size / 3);
+        const double deviation = 0.5 * std::sqrt(log_size * sample_size * (size - sample_size) / size) *
+                                 (2 * n < size ? -1 : 1);
+        const auto sample_begin = std::clamp<std::ptrdiff_t>(
+          static_cast<std::ptrdiff_t>(n - n * sample_size / size + deviation), 0, n);
+        const auto sample_end = std::clamp<std::ptrdiff_t>(
+          static_cast<std::ptrdiff_t>(n + (size - n) * sample_size / size + deviation) + 1, n + 1, size);
+
+        const auto sample_first = std::next(begin, sample_begin);
+        if constexpr (std::is_convertible<typename std::iterator_traits<ForwardIterator>::iterator_category,
+                                          std::random_access_iterator_tag>::value) {
+            // Draws the sample at random, so that it does not depend on the order left by previous partitions
+            auto& rng = internal::pivot_rng();
+            for (auto i = sample_begin; i < sample_end; ++i) {
+                const auto drawn = static_cast<std::ptrdiff_t>(rng() % static_cast<std::uint64_t>(size));
+                std::iter_swap(begin + i, begin + drawn);
+            }
+        }
+        return internal::select_impl<floyd_rivest>(
+          sample_first, std::next(sample_first, sample_end - sample_begin), n - sample_begin, compare);
     }
-    return partition_point;
-}
+};
 
-template <typename InputIterator,
-          typename BinaryPredicate = std::less<typename std::iterator_traits<InputIterator>::value_type>>
-void insertion_sort(InputIterator begin, InputIterator end, BinaryPredicate compare = BinaryPredicate{})
+/// Reads AlgoConfig::QUICKSORT_PIVOT_CHOICE on every call
+struct runtime
 {
-    internal::insertion_sort_impl<InputIterator, BinaryPredicate, void>(begin, end, compare, nullptr);
-}
+    template <typename ForwardIterator, typename BinaryPredicate>
+    static ForwardIterator choose(ForwardIterator begin, ForwardIterator end, BinaryPredicate& compare)
+    {
+        using Choice = internal::AlgoConfig::QuicksortPivotChoice;
+
+        switch (internal::AlgoConfig::QUICKSORT_PIVOT_CHOICE) {
+        case Choice::FIRST:
+            return first::choose(begin, end, compare);
+        case Choice::LAST:
+            return last::choose(begin, end, compare);
+        case Choice::SAMPLE_3:
+            return sample_3::choose(begin, end, compare);
+        case Choice::RANDOM:
+            return random::choose(begin, end, compare);
+        case Choice::NINTHER:
+            return ninther::choose(begin, end, compare);
+        case Choice::MEDIAN_OF_MEDIANS:
+            return median_of_medians::choose(begin, end, compare);
+        }
+        return begin; // Unreachable
+    }
+};
 
-template <typename InputIterator,
-          typename BinaryPredicate = std::less<typename std::iterator_traits<InputIterator>::value_type>>
-void selection_sort(InputIterator begin, InputIterator end, BinaryPredicate compare = BinaryPredicate{})
-{
-    internal::selection_sort_impl<InputIterator, BinaryPredicate>(begin, end, compare);
-}
+} // namespace pivot
 
-template <typename LInputIterator, typename RInputIterator, typename OutputIterator, typename BinaryPredicate>
-OutputIterator merge(LInputIterator left_begin,
-                     LInputIterator left_end,
-                     RInputIterator right_begin,
-                     RInputIterator right_end,
-                     OutputIterator out_begin,
-                     BinaryPredicate compare)
+namespace internal
 {
-    return internal::merge_impl<LInputIterator, RInputIterator, OutputIterator, BinaryPredicate>(
-      left_begin, left_end, right_begin, right_end, out_begin, compare, nullptr);
-}
 
-template <typename InputIterator,
-          typename OutputIterator,
-          typename BinaryPredicate = std::less<typename std::iterator_traits<InputIterator>::value_type>>
-OutputIterator merge_sort(InputIterator begin,
-                          InputIterator end,
-                          OutputIterator out_begin,
-                          BinaryPredicate compare = BinaryPredicate{})
+/// Pivot for selecting the entry of rank @n, for policies that can make use of it
+template <typename PivotPolicy, typename ForwardIterator, typename BinaryPredicate>
+ForwardIterator choose_pivot(ForwardIterator begin, ForwardIterator end, std::ptrdiff_t n, BinaryPredicate& compare)
 {
-    return internal::merge_sort_impl<InputIterator, OutputIterator, BinaryPredicate, void>(
-      begin, end, out_begin, compare, nullptr);
+    if constexpr (std::is_same_v<PivotPolicy, pivot::floyd_rivest>) {
+        return PivotPolicy::choose(begin, end, n, compare);
+    } else {
+        return PivotPolicy::choose(begin, end, compare);
+    }
 }
 
-/// In-situ merge-sort + inversion count
-template <typename InputIterator,
-          typename OutputIterator,
-          typename BinaryPredicate = std::less<typename std::iterator_traits<InputIterator>::value_type>>
-std::size_t sort_and_count_inversions(InputIterator begin,
-                                      InputIterator end,
-                                      OutputIterator out_begin,
-                                      BinaryPredicate compare = BinaryPredicate{})
+/**
+ * Introselect: reorders [ @begin , @end ) so that the @n th entry in sorted order is in its sorted position, and
+ * returns it. The range is narrowed iteratively around a three-way partition. Once the entries partitioned add up to
+ * more than 8 times the size of the range, poor pivots are assumed, and the remaining range is handed over to
+ * median_of_medians pivots. Selection is thus linear in the worst case, whatever @PivotPolicy.
+ */
+template <typename PivotPolicy, typename ForwardIterator, typename BinaryPredicate>
+ForwardIterator select_impl(ForwardIterator begin, ForwardIterator end, std::ptrdiff_t n, BinaryPredicate& compare)
 {
-    static_assert(std::is_convertible<typename std::iterator_traits<InputIterator>::iterator_category,
-                                      std::bidirectional_iterator_tag>::value,
-                  "InputIterator must be bidirectional");
+    constexpr std::ptrdiff_t sort_size = 16;
+    auto budget = 8 * std::distance(begin, end);
 
-    std::size_t swaps = 0;
-    internal::merge_sort_impl<InputIterator, OutputIterator, BinaryPredicate, std::size_t>(
-      begin, end, out_begin, compare, &swaps);
-    return swaps;
-}
+    while (true) {
+        const auto size = std::distance(begin, end);
+        assert(n < size);
 
-namespace internal
-{
+        if (size <= sort_size) {
+            non_recursive_sort<ForwardIterator, BinaryPredicate, void>(begin, end, compare, nullptr);
+            return std::next(begin, n);
+        }
 
-template <typename ForwardIterator, typename BinaryPredicate>
-ForwardIterator quick_sort_choose_pivot(ForwardIterator begin,
-                                        ForwardIterator end,
-                                        [[maybe_unused]] BinaryPredicate&& compare)
-{
-    assert(begin != end);
+        if constexpr (!std::is_same_v<PivotPolicy, pivot::median_of_medians>) {
+            budget -= size;
+            if (budget < 0) {
+                return select_impl<pivot::median_of_medians>(begin, end, n, compare);
+            }
+        }
 
-    switch (AlgoConfig::QUICKSORT_PIVOT_CHOICE) {
-    case AlgoConfig::QuicksortPivotChoice::FIRST:
-        return begin;
-    case AlgoConfig::QuicksortPivotChoice::LAST: {
-        const auto size = std::distance(begin, end);
-        return std::next(begin, size - 1);
-    }
-    case AlgoConfig::QuicksortPivotChoice::SAMPLE_3: {
-        const auto size = std::distance(begin, end);
-        const auto midpoint = (size - 1) / 2;
+        const auto pivot = *choose_pivot<PivotPolicy>(begin, end, n, compare);
+        auto [less_end, greater_begin] = my::partition_three_way(begin, end, pivot, compare);
 
-        auto midpoint_it = std::next(begin, midpoint);
-        auto last_it = std::next(midpoint_it, size - midpoint - 1);
-        std::array<ForwardIterator, 3> arr{begin, midpoint_it, last_it};
+        const auto n_less = std::distance(begin, less_end);
+        const auto n_not_greater = n_less + std::distance(less_end, greater_begin);
 
-        auto iter_comp = [&](const auto& it1, const auto& it2) { return compare(*it1, *it2); };
-        non_recursive_sort<typename std::array<ForwardIterator, 3>::iterator, decltype(iter_comp), void>(
-          arr.begin(), arr.end(), iter_comp, nullptr);
-        return arr[1];
+        if (n < n_less) {
+            end = less_end;
+        } else if (n < n_not_greater) {
+            return std::next(begin, n);
+        } else {
+            begin = greater_begin;
+            n -= n_not_greater;
+        }
     }
-    case AlgoConfig::QuicksortPivotChoice::RANDOM: {
-        const auto size = std::distance(begin, end);
+}
 
-        std::uniform_int_distribution<std::size_t> distrib(0, size - 1);
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        return std::next(begin, distrib(gen));
-    }
+/**
+ * Places the entries of every rank in the sorted range [ @ranks_begin , @ranks_end ) in their sorted positions. Ranks
+ * are offsets from the position @base, which @begin points to. Selecting the middle rank first splits the range, and
+ * the ranks, in two: every entry is partitioned O(log k) times for k ranks.
+ */
+template <typename PivotPolicy, typename ForwardIterator, typename BinaryPredicate>
+void multi_select_impl(ForwardIterator begin,
+                       ForwardIterator end,
+                       std::ptrdiff_t base,
+                       const std::ptrdiff_t* ranks_begin,
+                       const std::ptrdiff_t* ranks_end,
+                       BinaryPredicate& compare)
+{
+    while (ranks_begin != ranks_end) {
+        const auto* middle = ranks_begin + (ranks_end - ranks_begin) / 2;
+        auto nth = select_impl<PivotPolicy>(begin, end, *middle - base, compare);
+
+        multi_select_impl<PivotPolicy>(begin, nth, base, ranks_begin, middle, compare);
+        begin = std::next(nth);
+        base = *middle + 1;
+        ranks_begin = middle + 1;
     }
 }
 
@@ -361,8 +2707,9 @@ Iterator prev(Iterator it, [[maybe_unused]] Iterator anchor)
 inline std::size_t n_comparisons;
 #endif
 
-/// In-situ, non-randomized quicksort
-template <typename InputIterator,
+/// In-situ quicksort. The pivot is chosen according to @PivotPolicy (see namespace my::pivot).
+template <typename PivotPolicy = pivot::runtime,
+          typename InputIterator,
           typename BinaryPredicate = std::less<typename std::iterator_traits<InputIterator>::value_type>>
 void quick_sort(InputIterator begin, InputIterator end, BinaryPredicate compare = BinaryPredicate{})
 {
@@ -380,7 +2727,7 @@ void quick_sort(InputIterator begin, InputIterator end, BinaryPredicate compare
         return;
     }
 
-    auto pivot = internal::quick_sort_choose_pivot(begin, end, compare);
+    auto pivot = PivotPolicy::choose(begin, end, compare);
 
     // Copying pivot value to begin
     std::iter_swap(pivot, begin);
@@ -393,44 +2740,355 @@ void quick_sort(InputIterator begin, InputIterator end, BinaryPredicate compare
         auto last_left = internal::prev(partition_point, begin);
         std::iter_swap(pivot, last_left);
         begin = std::exchange(pivot, last_left);
-        quick_sort(begin, pivot, compare);
+        quick_sort<PivotPolicy>(begin, pivot, compare);
+    }
+    quick_sort<PivotPolicy>(partition_point, end, compare);
+}
+
+namespace internal
+{
+
+/// Recursion depth of quicksort with perfect pivots
+inline std::size_t floor_log2(std::ptrdiff_t size)
+{
+    std::size_t depth = 0;
+    for (; size > 1; size /= 2) {
+        ++depth;
+    }
+    return depth;
+}
+
+template <typename PivotPolicy, typename RandomAccessIterator, typename BinaryPredicate>
+void intro_sort_impl(RandomAccessIterator begin,
+                     RandomAccessIterator end,
+                     BinaryPredicate compare,
+                     std::size_t depth_limit)
+{
+    while (std::distance(begin, end) >= std::max<std::ptrdiff_t>(AlgoConfig::QUICKSORT_MIN_SIZE, 2)) {
+        if (depth_limit == 0) {
+            heap_sort_impl(begin, end, compare);
+            return;
+        }
+        --depth_limit;
+
+        const auto pivot = *PivotPolicy::choose(begin, end, compare);
+        auto [less_end, greater_begin] = my::partition_three_way(begin, end, pivot, compare);
+
+        // Recursing only into the smaller side bounds the stack depth to O(log n)
+        if (std::distance(begin, less_end) < std::distance(greater_begin, end)) {
+            intro_sort_impl<PivotPolicy>(begin, less_end, compare, depth_limit);
+            begin = greater_begin;
+        } else {
+            intro_sort_impl<PivotPolicy>(greater_begin, end, compare, depth_limit);
+            end = less_end;
+        }
+    }
+    non_recursive_sort<RandomAccessIterator, BinaryPredicate, void>(begin, end, compare, nullptr);
+}
+
+} // namespace internal
+
+/**
+ * In-situ introsort: quicksort with a three-way partition, that switches to heap-sort once the recursion gets deeper
+ * than 2 log2(n). Guaranteed O(n log n), and linear on inputs with few distinct keys.
+ */
+template <typename PivotPolicy = pivot::runtime,
+          typename RandomAccessIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>>
+void intro_sort(RandomAccessIterator begin, RandomAccessIterator end, BinaryPredicate compare = BinaryPredicate{})
+{
+    static_assert(std::is_convertible<typename std::iterator_traits<RandomAccessIterator>::iterator_category,
+                                      std::random_access_iterator_tag>::value,
+                  "RandomAccessIterator must be random-access");
+
+    const auto depth_limit = 2 * internal::floor_log2(std::distance(begin, end));
+    internal::intro_sort_impl<PivotPolicy>(begin, end, compare, depth_limit);
+}
+
+namespace internal
+{
+
+/// Every call sorts with its own pivot generator, seeded with @seed, and draws the seeds of its subtasks from it.
+template <typename PivotPolicy, typename RandomAccessIterator, typename BinaryPredicate>
+void parallel_quick_sort_impl(RandomAccessIterator begin,
+                              RandomAccessIterator end,
+                              BinaryPredicate compare,
+                              unsigned n_tasks,
+                              std::size_t depth_limit,
+                              std::uint64_t seed)
+{
+    const scoped_pivot_seed seeded(seed);
+
+    const auto size = std::distance(begin, end);
+    if (n_tasks < 2 || size < AlgoConfig::PARALLEL_MIN_SIZE || depth_limit == 0) {
+        intro_sort_impl<PivotPolicy>(begin, end, compare, 2 * floor_log2(size));
+        return;
+    }
+
+    const auto pivot = *PivotPolicy::choose(begin, end, compare);
+    auto less_end = parallel_partition(begin, end, [&](const auto& x) { return compare(x, pivot); }, n_tasks);
+    auto greater_begin =
+      parallel_partition(less_end, end, [&](const auto& x) { return !compare(pivot, x); }, n_tasks);
+
+    // An empty side needs no task: the other one keeps them all
+    if (less_end == begin) {
+        parallel_quick_sort_impl<PivotPolicy>(greater_begin, end, compare, n_tasks, depth_limit - 1, pivot_rng()());
+        return;
+    }
+    if (greater_begin == end) {
+        parallel_quick_sort_impl<PivotPolicy>(begin, less_end, compare, n_tasks, depth_limit - 1, pivot_rng()());
+        return;
+    }
+
+    // Tasks are shared out in proportion to the size of each side
+    const auto left_size = std::distance(begin, less_end);
+    const auto right_size = std::distance(greater_begin, end);
+    const auto left_tasks = static_cast<unsigned>(std::clamp<std::ptrdiff_t>(
+      (n_tasks * left_size + (left_size + right_size) / 2) / (left_size + right_size),
+      1,
+      n_tasks - 1));
+
+    // Seeds are drawn before the fork, in a fixed order
+    const auto left_seed = pivot_rng()();
+    const auto right_seed = pivot_rng()();
+    fork_join(
+      [&] {
+          parallel_quick_sort_impl<PivotPolicy>(begin, less_end, compare, left_tasks, depth_limit - 1, left_seed);
+      },
+      [&] {
+          parallel_quick_sort_impl<PivotPolicy>(
+            greater_begin, end, compare, n_tasks - left_tasks, depth_limit - 1, right_seed);
+      });
+}
+
+} // namespace internal
+
+/**
+ * Quicksort with an execution policy. Parallel policies sort both sides of every partition as concurrent tasks, and
+ * partition large ranges in parallel. Ranges shorter than AlgoConfig::PARALLEL_MIN_SIZE, and ranges where pivots keep
+ * being poor, are handed to the sequential intro_sort. std::execution::seq falls back to the sequential quick_sort.
+ */
+template <typename PivotPolicy = pivot::runtime,
+          typename ExecutionPolicy,
+          typename RandomAccessIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>>
+std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>> quick_sort(
+  ExecutionPolicy&&,
+  RandomAccessIterator begin,
+  RandomAccessIterator end,
+  BinaryPredicate compare = BinaryPredicate{})
+{
+    if constexpr (!internal::is_parallel_policy<ExecutionPolicy>()) {
+        quick_sort<PivotPolicy>(begin, end, compare);
+    } else {
+        static_assert(std::is_convertible<typename std::iterator_traits<RandomAccessIterator>::iterator_category,
+                                          std::random_access_iterator_tag>::value,
+                      "RandomAccessIterator must be random-access");
+
+        const auto size = std::distance(begin, end);
+        internal::parallel_quick_sort_impl<PivotPolicy>(begin,
+                                                        end,
+                                                        compare,
+                                                        internal::AlgoConfig::PARALLEL_TASKS,
+                                                        2 * internal::floor_log2(size),
+                                                        internal::pivot_rng()());
     }
-    quick_sort(partition_point, end, compare);
 }
 
 /**
  * Finds the @n th value in sorted order in an unsorted range [ @begin , @end ), according to ordering defined by
- * binary predicate @compare.
+ * binary predicate @compare. Entries before it end up not greater, and entries after it not less.
+ *
+ * Iterative introselect (see internal::select_impl): linear in the worst case for every @PivotPolicy.
+ * pivot::floyd_rivest needs the fewest comparisons on large random access ranges.
  */
-template <typename InputIterator,
+template <typename PivotPolicy = pivot::runtime,
+          typename InputIterator,
           typename BinaryPredicate = std::less<typename std::iterator_traits<InputIterator>::value_type>>
 InputIterator nth_element(InputIterator begin,
                           InputIterator end,
                           std::size_t n,
                           BinaryPredicate compare = BinaryPredicate{})
 {
-    std::size_t size = std::distance(begin, end);
-    assert(n < size);
+    assert(n < static_cast<std::size_t>(std::distance(begin, end)));
 
-    if (size == 1) {
-        return begin;
+    return internal::select_impl<PivotPolicy>(begin, end, static_cast<std::ptrdiff_t>(n), compare);
+}
+
+/**
+ * Multiple order statistics at once: places the entry of every rank in [ @ranks_begin , @ranks_end ) in its sorted
+ * position, as if by my::nth_element for each of them. Ranks may come in any order, and repeat.
+ *
+ * Complexity: O(n log k) for k distinct ranks, instead of O(n k) with separate nth_element calls.
+ */
+template <typename PivotPolicy = pivot::runtime,
+          typename ForwardIterator,
+          typename RankIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<ForwardIterator>::value_type>>
+void nth_elements(ForwardIterator begin,
+                  ForwardIterator end,
+                  RankIterator ranks_begin,
+                  RankIterator ranks_end,
+                  BinaryPredicate compare = BinaryPredicate{})
+{
+    std::vector<std::ptrdiff_t> ranks(ranks_begin, ranks_end);
+    std::sort(ranks.begin(), ranks.end());
+    ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+    if (ranks.empty()) {
+        return;
     }
+    assert(ranks.front() >= 0 && ranks.back() < std::distance(begin, end));
 
-    auto pivot = internal::quick_sort_choose_pivot(begin, end, compare);
-    std::iter_swap(pivot, begin);
-    pivot = std::exchange(begin, std::next(begin));
+    internal::multi_select_impl<PivotPolicy>(begin, end, 0, ranks.data(), ranks.data() + ranks.size(), compare);
+}
 
-    auto partition_point = my::partition(begin, end, [&](const auto& x) -> bool { return compare(x, *pivot); });
-    std::size_t pivot_pos = std::distance(begin, partition_point);
+/// Multiple order statistics at once, e.g. `nth_elements(begin, end, {p50, p90, p99})`
+template <typename PivotPolicy = pivot::runtime,
+          typename ForwardIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<ForwardIterator>::value_type>>
+void nth_elements(ForwardIterator begin,
+                  ForwardIterator end,
+                  std::initializer_list<std::size_t> ranks,
+                  BinaryPredicate compare = BinaryPredicate{})
+{
+    nth_elements<PivotPolicy>(begin, end, ranks.begin(), ranks.end(), compare);
+}
+
+/**
+ * In-situ partial sort: the first @middle - @begin values of [ @begin , @end ) in sorted order end up sorted in
+ * [ @begin , @middle ). The remaining values are left in [ @middle , @end ) in unspecified order.
+ *
+ * Complexity: linear selection of the boundary (see nth_element), then O(k log k) to sort the first k values. On random
+ * access ranges much longer than k, the first k values are gathered in a heap instead: O(n + k log k log(n / k)) on
+ * average.
+ */
+template <typename PivotPolicy = pivot::runtime,
+          typename ForwardIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<ForwardIterator>::value_type>>
+void partial_sort(ForwardIterator begin,
+                  ForwardIterator middle,
+                  ForwardIterator end,
+                  BinaryPredicate compare = BinaryPredicate{})
+{
+    if (begin == middle) {
+        return;
+    }
+
+    const auto k = std::distance(begin, middle);
+    constexpr bool random_access =
+      std::is_convertible<typename std::iterator_traits<ForwardIterator>::iterator_category,
+                          std::random_access_iterator_tag>::value;
+
+    // A heap of the first k values only costs a comparison per value that does not make it in: cheaper than selection
+    // when k is much smaller than the range
+    if constexpr (random_access) {
+        if (k < std::distance(begin, end) / 256) {
+            internal::heap_select_impl(begin, middle, end, compare);
+            internal::sort_heap_impl(begin, middle, compare);
+            return;
+        }
+    }
+
+    if (middle != end) {
+        internal::select_impl<PivotPolicy>(begin, end, k - 1, compare);
+    }
+
+    if constexpr (random_access) {
+        internal::intro_sort_impl<PivotPolicy>(begin, middle, compare, 2 * internal::floor_log2(k));
+    } else {
+        quick_sort<PivotPolicy>(begin, middle, compare);
+    }
+}
 
-    if (pivot_pos > n) {
-        return nth_element(begin, partition_point, n, compare);
+/**
+ * Copies the first values of [ @begin , @end ) in sorted order, as many as fit in [ @out_begin , @out_end ), sorted
+ * into the output range. Returns the end of the values written.
+ *
+ * The input is read in a single pass, and the output range is used as a max-heap of the best values so far: no memory
+ * is allocated, and input iterators (e.g. std::istream_iterator) are enough.
+ *
+ * Complexity: O(n log k) for an output range of k values.
+ */
+template <typename InputIterator,
+          typename RandomAccessIterator,
+          typename BinaryPredicate = std::less<typename std::iterator_traits<InputIterator>::value_type>>
+RandomAccessIterator partial_sort_copy(InputIterator begin,
+                                       InputIterator end,
+                                       RandomAccessIterator out_begin,
+                                       RandomAccessIterator out_end,
+                                       BinaryPredicate compare = BinaryPredicate{})
+{
+    auto out = out_begin;
+    for (; begin != end && out != out_end; ++begin, ++out) {
+        *out = *begin;
+        internal::sift_up(out_begin, std::distance(out_begin, out), compare);
     }
-    if (pivot_pos < n) {
-        return nth_element(partition_point, end, n - pivot_pos - 1, compare);
+
+    const auto k = std::distance(out_begin, out);
+    for (; begin != end; ++begin) {
+        if (compare(*begin, *out_begin)) {
+            *out_begin = *begin;
+            internal::sift_down(out_begin, 0, k, compare);
+        }
     }
 
-    return pivot;
+    internal::sort_heap_impl(out_begin, out, compare);
+    return out;
 }
 
+/**
+ * Streaming top-k: keeps the first @k values in sorted order among all the values pushed so far, in O(k) memory. The
+ * values are kept in a max-heap, so that pushing a value costs O(log k) at worst, and a single comparison when it does
+ * not make it into the top k.
+ *
+ * "First" values are the least ones according to @compare: pass std::greater to keep the greatest ones.
+ */
+template <typename T, typename BinaryPredicate = std::less<T>>
+class top_k
+{
+  public:
+    explicit top_k(std::size_t k, BinaryPredicate compare = BinaryPredicate{}) : k_{k}, compare_{compare}
+    {
+        heap_.reserve(k);
+    }
+
+    void push(const T& value)
+    {
+        if (heap_.size() < k_) {
+            heap_.push_back(value);
+            internal::sift_up(heap_.begin(), static_cast<std::ptrdiff_t>(heap_.size()) - 1, compare_);
+        } else if (k_ > 0 && compare_(value, heap_.front())) {
+            heap_.front() = value;
+            internal::sift_down(heap_.begin(), 0, static_cast<std::ptrdiff_t>(heap_.size()), compare_);
+        }
+    }
+
+    template <typename InputIterator>
+    void push(InputIterator begin, InputIterator end)
+    {
+        for (; begin != end; ++begin) {
+            push(*begin);
+        }
+    }
+
+    /// Number of values kept: k, unless fewer values were pushed
+    std::size_t size() const
+    {
+        return heap_.size();
+    }
+
+    /// The values kept, in sorted order
+    std::vector<T> sorted() const
+    {
+        auto values = heap_;
+        internal::sort_heap_impl(values.begin(), values.end(), compare_);
+        return values;
+    }
+
+  private:
+    std::size_t k_;
+    BinaryPredicate compare_;
+    std::vector<T> heap_;
+};
+
 } // namespace my
@@ -0,0 +1,514 @@
+#pragma once
+
+#include "algorithms.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <random>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace my
+{
+
+/// Tuning of external_sort
+struct external_sort_config
+{
+    std::size_t memory_budget = std::size_t{256} << 20; // Bytes of records held in memory at once, buffers included
+    std::size_t block_bytes = std::size_t{4} << 20;     // Size of every read and write during the merge
+    bool async_io = true; // Prefetch runs and write the output on background threads while merging
+    std::filesystem::path temp_directory = std::filesystem::temp_directory_path(); // Where runs are written
+};
+
+/// What external_sort did
+struct external_sort_stats
+{
+    std::uint64_t records = 0;      // Number of records sorted
+    std::uint64_t runs = 0;         // Number of sorted runs written by run formation
+    std::uint64_t merge_passes = 0; // Number of times records went through a k-way merge
+    std::uint64_t bytes_read = 0;
+    std::uint64_t bytes_written = 0;
+    std::uint64_t read_calls = 0;
+    std::uint64_t write_calls = 0;
+};
+
+namespace internal
+{
+
+/// I/O statistics, updated by the background reads and writes of every file of a sort
+struct io_counters
+{
+    std::atomic<std::uint64_t> bytes_read{0};
+    std::atomic<std::uint64_t> bytes_written{0};
+    std::atomic<std::uint64_t> read_calls{0};
+    std::atomic<std::uint64_t> write_calls{0};
+};
+
+[[noreturn]] inline void throw_io_error(const char* what, const std::filesystem::path& path, int error = errno)
+{
+    throw std::filesystem::filesystem_error(what, path, std::error_code(error, std::generic_category()));
+}
+
+/// Unbuffered binary file: every read and write goes straight to the system, in the caller's blocks
+class binary_file
+{
+  public:
+    binary_file(const std::filesystem::path& path, const char* mode, io_counters& counters)
+        : path_{path}, handle_{std::fopen(path.string().c_str(), mode)}, counters_{counters}
+    {
+        if (handle_ == nullptr) {
+            throw_io_error("cannot open file", path_);
+        }
+        std::setvbuf(handle_, nullptr, _IONBF, 0);
+    }
+
+    binary_file(const binary_file&) = delete;
+    binary_file& operator=(const binary_file&) = delete;
+
+    ~binary_file()
+    {
+        if (handle_ != nullptr) {
+            std::fclose(handle_);
+        }
+    }
+
+    /// Reads up to @bytes bytes into @data, and returns how many were read: fewer only at the end of the file
+    std::size_t read(void* data, std::size_t bytes)
+    {
+        if (bytes == 0) {
+            return 0;
+        }
+        const auto n_read = std::fread(data, 1, bytes, handle_);
+        if (n_read < bytes && std::ferror(handle_)) {
+            throw_io_error("cannot read file", path_);
+        }
+        counters_.bytes_read += n_read;
+        ++counters_.read_calls;
+        return n_read;
+    }
+
+    void write(const void* data, std::size_t bytes)
+    {
+        if (bytes == 0) {
+            return;
+        }
+        if (std::fwrite(data, 1, bytes, handle_) != bytes) {
+            throw_io_error("cannot write file", path_);
+        }
+        counters_.bytes_written += bytes;
+        ++counters_.write_calls;
+    }
+
+    /// Closes the file, reporting errors that writes may have deferred
+    void close()
+    {
+        const auto result = std::fclose(std::exchange(handle_, nullptr));
+        if (result != 0) {
+            throw_io_error("cannot close file", path_);
+        }
+    }
+
+  private:
+    std::filesystem::path path_;
+    std::FILE* handle_;
+    io_counters& counters_;
+};
+
+/// Reads records of type T into @buffer, up to its capacity. Returns false once the file has been read entirely.
+template <typename T>
+bool read_records(binary_file& file, std::vector<T>& buffer, const std::filesystem::path& path)
+{
+    buffer.resize(buffer.capacity());
+    const auto bytes = file.read(buffer.data(), buffer.size() * sizeof(T));
+    if (bytes % sizeof(T) != 0) {
+        throw_io_error("file size is not a multiple of the record size", path, EINVAL);
+    }
+    buffer.resize(bytes / sizeof(T));
+    return buffer.size() == buffer.capacity();
+}
+
+/**
+ * Sequential reader of a file of records, one block at a time. With asynchronous I/O, the next block is read on a
+ * background thread while the current one is consumed (double buffering).
+ */
+template <typename T>
+class run_reader
+{
+  public:
+    run_reader(const std::filesystem::path& path, std::size_t block_size, bool async_io, io_counters& counters)
+        : path_{path}, file_{path, "rb", counters}, async_io_{async_io}
+    {
+        current_.reserve(block_size);
+        next_.reserve(async_io_ ? block_size : 0);
+        more_ = read_records(file_, current_, path_);
+        prefetch();
+    }
+
+    run_reader(const run_reader&) = delete;
+    run_reader& operator=(const run_reader&) = delete;
+
+    ~run_reader()
+    {
+        if (pending_.valid()) {
+            pending_.wait();
+        }
+    }
+
+    bool empty() const
+    {
+        return position_ == current_.size();
+    }
+
+    const T& front() const
+    {
+        return current_[position_];
+    }
+
+    void pop()
+    {
+        if (++position_ == current_.size()) {
+            refill();
+        }
+    }
+
+  private:
+    void prefetch()
+    {
+        if (async_io_ && more_) {
+            pending_ = std::async(std::launch::async, [this] { return read_records(file_, next_, path_); });
+        }
+    }
+
+    void refill()
+    {
+        position_ = 0;
+        if (pending_.valid()) {
+            more_ = pending_.get();
+            current_.swap(next_);
+            prefetch();
+        } else if (more_) {
+            more_ = read_records(file_, current_, path_);
+        } else {
+            current_.clear();
+        }
+    }
+
+    std::filesystem::path path_;
+    binary_file file_;
+    bool async_io_;
+    bool more_ = false; // Whether the file may hold records past those read so far
+    std::vector<T> current_;
+    std::vector<T> next_; // Block being prefetched
+    std::size_t position_ = 0;
+    std::future<bool> pending_;
+};
+
+/**
+ * Sequential writer of a file of records, one block at a time. With asynchronous I/O, full blocks are written on a
+ * background thread while the next one is filled (double buffering).
+ */
+template <typename T>
+class run_writer
+{
+  public:
+    run_writer(const std::filesystem::path& path, std::size_t block_size, bool async_io, io_counters& counters)
+        : file_{path, "wb", counters}, async_io_{async_io}
+    {
+        current_.reserve(block_size);
+        spare_.reserve(async_io_ ? block_size : 0);
+    }
+
+    run_writer(const run_writer&) = delete;
+    run_writer& operator=(const run_writer&) = delete;
+
+    ~run_writer()
+    {
+        if (pending_.valid()) {
+            pending_.wait();
+        }
+    }
+
+    void push(const T& value)
+    {
+        current_.push_back(value);
+        if (current_.size() == current_.capacity()) {
+            flush();
+        }
+    }
+
+    /// Writes the remaining records and closes the file
+    void close()
+    {
+        flush();
+        if (pending_.valid()) {
+            pending_.get();
+        }
+        file_.close();
+    }
+
+  private:
+    void flush()
+    {
+        if (current_.empty()) {
+            return;
+        }
+        if (!async_io_) {
+            file_.write(current_.data(), current_.size() * sizeof(T));
+            current_.clear();
+            return;
+        }
+        if (pending_.valid()) {
+            pending_.get();
+        }
+        current_.swap(spare_);
+        current_.clear();
+        pending_ = std::async(std::launch::async, [this] { file_.write(spare_.data(), spare_.size() * sizeof(T)); });
+    }
+
+    binary_file file_;
+    bool async_io_;
+    std::vector<T> current_;
+    std::vector<T> spare_; // Block being written
+    std::future<void> pending_;
+};
+
+/**
+ * Tournament tree of losers over k sorted sources: every internal node holds the source that lost the match played
+ * there, and the overall winner is kept apart. Taking the least record replays only the matches on the path of its
+ * source, log2(k) comparisons against the stored losers. Exhausted sources lose every match; ties go to the source
+ * with the lower index, so that runs merge in the order they were written.
+ */
+template <typename Source, typename BinaryPredicate>
+class loser_tree
+{
+  public:
+    loser_tree(std::deque<Source>& sources, BinaryPredicate compare)
+        : sources_{sources}, compare_{compare}, losers_(sources.size())
+    {
+        winner_ = sources_.empty() ? 0 : initialize(1);
+    }
+
+    bool empty() const
+    {
+        return sources_.empty() || sources_[winner_].empty();
+    }
+
+    /// Least record among all sources
+    const auto& top() const
+    {
+        return sources_[winner_].front();
+    }
+
+    void pop()
+    {
+        auto winner = winner_;
+        sources_[winner].pop();
+        for (auto node = (winner + sources_.size()) / 2; node > 0; node /= 2) {
+            if (beats(losers_[node], winner)) {
+                std::swap(losers_[node], winner);
+            }
+        }
+        winner_ = winner;
+    }
+
+  private:
+    /// Whether source @a wins its match against source @b
+    bool beats(std::size_t a, std::size_t b) const
+    {
+        if (sources_[b].empty()) {
+            return true;
+        }
+        if (sources_[a].empty()) {
+            return false;
+        }
+        const auto& x = sources_[a].front();
+        const auto& y = sources_[b].front();
+        return compare_(x, y) || (!compare_(y, x) && a < b);
+    }
+
+    /// Plays every match of the subtree at @node, and returns its winner. Nodes from sources_.size() on are leaves.
+    std::size_t initialize(std::size_t node)
+    {
+        if (node >= sources_.size()) {
+            return node - sources_.size();
+        }
+        auto left = initialize(2 * node);
+        auto right = initialize(2 * node + 1);
+        if (beats(left, right)) {
+            losers_[node] = right;
+            return left;
+        }
+        losers_[node] = left;
+        return right;
+    }
+
+    std::deque<Source>& sources_;
+    BinaryPredicate compare_;
+    std::vector<std::size_t> losers_; // 1-based
+    std::size_t winner_;
+};
+
+/// Temporary run files, removed when the sort is over, however it ends
+class temp_files
+{
+  public:
+    explicit temp_files(std::filesystem::path directory) : directory_{std::move(directory)}
+    {
+        std::random_device random;
+        prefix_ = "my_external_sort_" + std::to_string(random()) + std::to_string(random()) + "_";
+    }
+
+    temp_files(const temp_files&) = delete;
+    temp_files& operator=(const temp_files&) = delete;
+
+    ~temp_files()
+    {
+        std::error_code ignored;
+        for (const auto& path : paths_) {
+            std::filesystem::remove(path, ignored);
+        }
+    }
+
+    std::filesystem::path create()
+    {
+        paths_.push_back(directory_ / (prefix_ + std::to_string(paths_.size())));
+        return paths_.back();
+    }
+
+    /// Removes the file at @path early, to free disk space for the next merge pass
+    void remove(const std::filesystem::path& path)
+    {
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+    }
+
+  private:
+    std::filesystem::path directory_;
+    std::string prefix_;
+    std::vector<std::filesystem::path> paths_;
+};
+
+/// Merges the sorted runs at @inputs into the file at @output
+template <typename T, typename BinaryPredicate>
+void merge_runs(const std::vector<std::filesystem::path>& inputs,
+                const std::filesystem::path& output,
+                std::size_t block_size,
+                bool async_io,
+                io_counters& counters,
+                BinaryPredicate compare)
+{
+    std::deque<run_reader<T>> readers; // Readers never move: their prefetches write into them
+    for (const auto& input : inputs) {
+        readers.emplace_back(input, block_size, async_io, counters);
+    }
+
+    run_writer<T> writer(output, block_size, async_io, counters);
+    for (loser_tree<run_reader<T>, BinaryPredicate> tree(readers, compare); !tree.empty(); tree.pop()) {
+        writer.push(tree.top());
+    }
+    writer.close();
+}
+
+} // namespace internal
+
+/**
+ * Sorts a binary file of records of type T too large for memory, according to @compare, into the file at @output.
+ *
+ * Run formation reads the input in chunks as large as the memory budget allows, sorts each one with the parallel
+ * quick_sort and writes it to a temporary file in @config.temp_directory. Runs are then merged with a loser tree,
+ * as many at a time as there is memory for two blocks per run: a block being consumed and, with @config.async_io, a
+ * block being prefetched. Runs that do not fit in a single merge are first merged into longer runs. The output is
+ * written in blocks, in the background with @config.async_io. Like quick_sort, the sort is not stable.
+ *
+ * Throws std::filesystem::filesystem_error on I/O errors. Temporary files are removed either way.
+ *
+ * Complexity: O(n log n) comparisons, and 2 n (1 + merge passes) bytes of sequential I/O.
+ */
+template <typename T, typename BinaryPredicate = std::less<T>>
+external_sort_stats external_sort(const std::filesystem::path& input,
+                                  const std::filesystem::path& output,
+                                  const external_sort_config& config = external_sort_config{},
+                                  BinaryPredicate compare = BinaryPredicate{})
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Records must be trivially copyable");
+
+    internal::io_counters counters;
+    internal::temp_files temps(config.temp_directory);
+    external_sort_stats stats;
+
+    // Run formation
+    const auto input_bytes = std::filesystem::file_size(input);
+    if (input_bytes % sizeof(T) != 0) {
+        internal::throw_io_error("file size is not a multiple of the record size", input, EINVAL);
+    }
+    stats.records = input_bytes / sizeof(T);
+
+    std::vector<std::filesystem::path> runs;
+    {
+        internal::binary_file in(input, "rb", counters);
+        std::vector<T> chunk;
+        const auto chunk_size = std::max<std::size_t>(1, config.memory_budget / sizeof(T));
+        chunk.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(chunk_size, stats.records)));
+
+        auto remaining = stats.records;
+        do {
+            internal::read_records(in, chunk, input);
+            remaining -= std::min<std::uint64_t>(remaining, chunk.size());
+            my::quick_sort(std::execution::par, chunk.begin(), chunk.end(), compare);
+
+            // A single chunk is the sorted output
+            runs.push_back(remaining == 0 && runs.empty() ? output : temps.create());
+            internal::binary_file out(runs.back(), "wb", counters);
+            out.write(chunk.data(), chunk.size() * sizeof(T));
+            out.close();
+        } while (remaining > 0 && !chunk.empty());
+    }
+    stats.runs = runs.size();
+
+    // Merge passes: two blocks per input run, and two for the output. Blocks shrink down to 64 KiB so that every run
+    // fits in a single merge, and are never so large that fewer than three runs fit.
+    const auto one_pass_block_bytes = std::max<std::size_t>(config.memory_budget / (2 * (runs.size() + 1)), 64 << 10);
+    const auto block_bytes =
+      std::max(sizeof(T), std::min({config.block_bytes, config.memory_budget / 8, one_pass_block_bytes}));
+    const auto block_size = block_bytes / sizeof(T);
+    const auto fan_in = std::max<std::size_t>(2, config.memory_budget / (2 * block_bytes) - 1);
+
+    while (runs.size() > 1 || runs.front() != output) {
+        const bool last_pass = runs.size() <= fan_in;
+        std::vector<std::filesystem::path> merged;
+        for (std::size_t first = 0; first < runs.size(); first += fan_in) {
+            const auto last = std::min(runs.size(), first + fan_in);
+            if (last - first == 1 && !last_pass) {
+                merged.push_back(runs[first]);
+                continue;
+            }
+
+            const std::vector<std::filesystem::path> group(runs.begin() + first, runs.begin() + last);
+            merged.push_back(last_pass ? output : temps.create());
+            internal::merge_runs<T>(group, merged.back(), block_size, config.async_io, counters, compare);
+            for (const auto& run : group) {
+                temps.remove(run);
+            }
+        }
+        runs.swap(merged);
+        ++stats.merge_passes;
+    }
+
+    stats.bytes_read = counters.bytes_read;
+    stats.bytes_written = counters.bytes_written;
+    stats.read_calls = counters.read_calls;
+    stats.write_calls = counters.write_calls;
+    return stats;
+}
+
+} // namespace my
@@ -0,0 +1,268 @@
+#pragma once
+
+#include "algorithms.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <execution>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <string>
+#endif
+
+namespace my
+{
+
+namespace internal
+{
+
+/// Read-only view of a whole file: memory-mapped where the platform allows it, read into memory otherwise
+class mapped_file
+{
+  public:
+    explicit mapped_file(const std::filesystem::path& path)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw_error("cannot open file", path, errno);
+        }
+        struct stat status;
+        if (::fstat(fd, &status) != 0) {
+            const int error = errno; // close() may overwrite it
+            ::close(fd);
+            throw_error("cannot stat file", path, error);
+        }
+
+        size_ = static_cast<std::size_t>(status.st_size);
+        if (size_ != 0) {
+            data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data_ == MAP_FAILED) {
+                const int error = errno;
+                ::close(fd);
+                throw_error("cannot map file", path, error);
+            }
+            ::madvise(data_, size_, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+#else
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw_error("cannot open file", path, errno);
+        }
+        contents_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+#endif
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        if (size_ != 0) {
+            ::munmap(data_, size_);
+        }
+#endif
+    }
+
+    std::string_view view() const
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        return {static_cast<const char*>(data_), size_};
+#else
+        return contents_;
+#endif
+    }
+
+  private:
+    [[noreturn]] static void throw_error(const char* what, const std::filesystem::path& path, int error)
+    {
+        throw std::filesystem::filesystem_error(what, path, std::error_code(error, std::generic_category()));
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+#else
+    std::string contents_;
+#endif
+};
+
+inline bool is_digit(char c)
+{
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+/**
+ * SWAR digit scanner: finds how many of the 8 characters at @text are leading decimal digits, and stores their value
+ * in @value. The 8 bytes are handled as a single 64-bit word, without a branch per character: digits are those bytes
+ * whose value minus '0' is below 10, and the digits are combined pairwise with three multiplications.
+ */
+inline unsigned parse_eight_digits(const char* text, std::uint64_t& value)
+{
+    std::uint64_t word;
+    std::memcpy(&word, text, sizeof(word));
+
+    // Bytes that are digits become 0-9 with a clear high nibble, and stay below 0x10 once 6 is added to them
+    const auto digits = word ^ 0x3030303030303030;
+    const auto non_digits = (digits & 0xF0F0F0F0F0F0F0F0) | ((digits + 0x0606060606060606) & 0x1010101010101010);
+#if defined(__GNUC__) || defined(__clang__)
+    const auto n_digits = non_digits == 0 ? 8u : static_cast<unsigned>(__builtin_ctzll(non_digits)) / 8;
+#else
+    unsigned n_digits = 0;
+    while (n_digits < 8 && (non_digits >> (8 * n_digits) & 0xFF) == 0) {
+        ++n_digits;
+    }
+#endif
+    if (n_digits == 0) {
+        value = 0;
+        return 0;
+    }
+
+    // Leading zeros take the place of the bytes past the digits, as the least significant bytes hold the first digits
+    auto x = digits << (8 * (8 - n_digits));
+    x = (x * 10 + (x >> 8)) & 0x00FF00FF00FF00FF;
+    x = (x * 100 + (x >> 16)) & 0x0000FFFF0000FFFF;
+    value = (x * 10000 + (x >> 32)) & 0xFFFFFFFF;
+    return n_digits;
+}
+
+/**
+ * Parses the integers of [ @begin , @end ) into @out. Every character but digits and minus signs (for signed types)
+ * separates integers. Values must fit in Integer.
+ */
+template <typename Integer>
+void parse_integers_impl(const char* begin, const char* end, std::vector<Integer>& out)
+{
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    constexpr bool use_swar = true;
+#else
+    constexpr bool use_swar = false;
+#endif
+    constexpr std::uint64_t powers_of_10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+    for (auto it = begin;;) {
+        while (it != end && !is_digit(*it)) {
+            ++it;
+        }
+        if (it == end) {
+            return;
+        }
+        const bool negative = std::is_signed<Integer>::value && it != begin && it[-1] == '-';
+
+        std::uint64_t value = 0;
+        bool in_number = true;
+        if constexpr (use_swar) {
+            while (in_number && end - it >= 8) {
+                std::uint64_t digits;
+                const auto n_digits = parse_eight_digits(it, digits);
+                value = value * powers_of_10[n_digits] + digits;
+                it += n_digits;
+                in_number = n_digits == 8;
+            }
+        }
+        for (; in_number && it != end && is_digit(*it); ++it) {
+            value = value * 10 + static_cast<std::uint64_t>(*it - '0');
+        }
+
+        out.push_back(static_cast<Integer>(negative ? ~value + 1 : value));
+    }
+}
+
+} // namespace internal
+
+/**
+ * Integers written in decimal in @text, separated by any other characters: whitespace, commas... A minus sign right
+ * before a number makes it negative, for signed types. Digits are scanned eight at a time (see
+ * internal::parse_eight_digits).
+ */
+template <typename Integer>
+std::vector<Integer> parse_integers(std::string_view text)
+{
+    static_assert(std::is_integral<Integer>::value && !std::is_same<Integer, bool>::value, "Integer must be integral");
+
+    std::vector<Integer> values;
+    values.reserve(text.size() / 8);
+    internal::parse_integers_impl(text.data(), text.data() + text.size(), values);
+    return values;
+}
+
+/**
+ * parse_integers with an execution policy. Parallel policies split @text at line breaks into chunks of at least 1 MiB,
+ * at most AlgoConfig::PARALLEL_TASKS of them, parse the chunks concurrently and gather their values into a vector of
+ * the exact size. std::execution::seq falls back to the sequential parse_integers.
+ */
+template <typename Integer, typename ExecutionPolicy>
+std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>, std::vector<Integer>> parse_integers(
+  ExecutionPolicy&&, std::string_view text)
+{
+    if constexpr (!internal::is_parallel_policy<ExecutionPolicy>()) {
+        return parse_integers<Integer>(text);
+    } else {
+        constexpr std::size_t min_chunk_size = std::size_t{1} << 20;
+        const auto n_chunks = static_cast<unsigned>(std::clamp<std::size_t>(
+          text.size() / min_chunk_size, 1, std::max(internal::AlgoConfig::PARALLEL_TASKS, 1u)));
+
+        // Chunk k spans [ bounds[k] , bounds[k + 1] ), every bound but the outer ones following a line break
+        std::vector<std::size_t> bounds(n_chunks + 1, text.size());
+        bounds[0] = 0;
+        for (unsigned k = 1; k < n_chunks; ++k) {
+            const auto line_break = text.find('\n', std::max(bounds[k - 1], k * (text.size() / n_chunks)));
+            bounds[k] = line_break == std::string_view::npos ? text.size() : line_break + 1;
+        }
+
+        std::vector<std::vector<Integer>> chunks(n_chunks);
+        internal::parallel_for(n_chunks, [&](unsigned k) {
+            chunks[k].reserve((bounds[k + 1] - bounds[k]) / 8);
+            internal::parse_integers_impl(text.data() + bounds[k], text.data() + bounds[k + 1], chunks[k]);
+        });
+
+        std::vector<std::size_t> offsets(n_chunks + 1, 0);
+        for (unsigned k = 0; k < n_chunks; ++k) {
+            offsets[k + 1] = offsets[k] + chunks[k].size();
+        }
+
+        std::vector<Integer> values(offsets.back());
+        internal::parallel_for(n_chunks, [&](unsigned k) {
+            std::copy(chunks[k].cbegin(), chunks[k].cend(), values.begin() + offsets[k]);
+            std::vector<Integer>().swap(chunks[k]);
+        });
+        return values;
+    }
+}
+
+/**
+ * Integers written in decimal in the file at @path (see parse_integers). The file is memory-mapped rather than read
+ * through a stream. Throws std::filesystem::filesystem_error if it cannot be read.
+ */
+template <typename Integer>
+std::vector<Integer> load_integers(const std::filesystem::path& path)
+{
+    const internal::mapped_file file(path);
+    return parse_integers<Integer>(file.view());
+}
+
+/// load_integers with an execution policy, parsing the file as parse_integers does with that policy
+template <typename Integer, typename ExecutionPolicy>
+std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>, std::vector<Integer>> load_integers(
+  ExecutionPolicy&& policy, const std::filesystem::path& path)
+{
+    const internal::mapped_file file(path);
+    return parse_integers<Integer>(std::forward<ExecutionPolicy>(policy), file.view());
+}
+
+} // namespace my
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace my
+{
+
+namespace internal
+{
+
+template <std::size_t Bytes>
+struct unsigned_of_size;
+
+template <>
+struct unsigned_of_size<1>
+{
+    using type = std::uint8_t;
+};
+
+template <>
+struct unsigned_of_size<2>
+{
+    using type = std::uint16_t;
+};
+
+template <>
+struct unsigned_of_size<4>
+{
+    using type = std::uint32_t;
+};
+
+template <>
+struct unsigned_of_size<8>
+{
+    using type = std::uint64_t;
+};
+
+/// Unsigned integer such that comparing radix keys is the same as comparing values of type T
+template <typename T>
+using radix_key_t = typename unsigned_of_size<sizeof(T)>::type;
+
+/**
+ * Maps @value to an unsigned key with the same ordering:
+ * - Unsigned integers are left as they are.
+ * - Signed integers get their sign bit flipped.
+ * - Floating point numbers get their sign bit flipped if positive, and all their bits flipped if negative. NaNs are
+ *   ordered by their bit pattern: negative NaNs first, positive NaNs last.
+ */
+template <typename T>
+radix_key_t<T> radix_key(T value)
+{
+    static_assert(std::is_arithmetic<T>::value && sizeof(T) <= 8, "T must be arithmetic, and 64 bits at most");
+    using Key = radix_key_t<T>;
+    constexpr Key sign_bit = Key{1} << (sizeof(Key) * CHAR_BIT - 1);
+
+    Key key;
+    std::memcpy(&key, &value, sizeof(Key));
+
+    if constexpr (std::is_floating_point<T>::value) {
+        return (key & sign_bit) ? Key(~key) : Key(key | sign_bit);
+    } else if constexpr (std::is_signed<T>::value) {
+        return key ^ sign_bit;
+    } else {
+        return key;
+    }
+}
+
+/// Digit layout of the radix key of T. Defaults to 11-bit digits for keys of 32 bits and wider, 8-bit otherwise.
+template <typename T, unsigned DigitBits = (sizeof(T) >= 4 ? 11 : 8)>
+struct radix_config
+{
+    static constexpr unsigned key_bits = sizeof(T) * CHAR_BIT;
+    static constexpr unsigned digit_bits = DigitBits;
+    static constexpr unsigned n_digits = (key_bits + digit_bits - 1) / digit_bits;
+    static constexpr std::size_t n_buckets = std::size_t{1} << digit_bits;
+
+    static std::size_t digit(radix_key_t<T> key, unsigned d)
+    {
+        return (key >> (d * digit_bits)) & (n_buckets - 1);
+    }
+};
+
+/**
+ * Least significant digit first radix sort of @size entries starting at @data, using the range starting at @buffer
+ * as working memory. Histograms for every digit are built in a single pass. Digits that are the same for every entry
+ * are skipped.
+ *
+ * Returns whether the sorted output ended up in @buffer rather than in @data.
+ */
+template <typename T>
+bool lsd_radix_sort_impl(T* data, T* buffer, std::size_t size)
+{
+    using Config = radix_config<T>;
+
+    std::vector<std::array<std::size_t, Config::n_buckets>> histograms(Config::n_digits);
+    for (std::size_t i = 0; i < size; ++i) {
+        const auto key = radix_key(data[i]);
+        for (unsigned d = 0; d < Config::n_digits; ++d) {
+            ++histograms[d][Config::digit(key, d)];
+        }
+    }
+
+    T* src = data;
+    T* dst = buffer;
+    for (unsigned d = 0; d < Config::n_digits; ++d) {
+        auto& offsets = histograms[d];
+        if (std::find(offsets.cbegin(), offsets.cend(), size) != offsets.cend()) {
+            continue; // Single bucket
+        }
+
+        std::size_t sum = 0;
+        for (auto& offset : offsets) {
+            sum += std::exchange(offset, sum);
+        }
+
+        for (std::size_t i = 0; i < size; ++i) {
+            dst[offsets[Config::digit(radix_key(src[i]), d)]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    return src == buffer;
+}
+
+/**
+ * Most significant digit first, in-situ radix sort (American flag sort) on 8-bit digits. Entries are permuted into
+ * their buckets by following swap cycles, and every bucket is then sorted recursively on the next digit. Small
+ * buckets are insertion-sorted.
+ */
+template <typename T>
+void msd_radix_sort_impl(T* data, std::size_t size, int digit)
+{
+    using Config = radix_config<T, 8>;
+    constexpr std::size_t insertion_sort_size = 64;
+
+    if (size < insertion_sort_size || digit < 0) {
+        for (std::size_t i = 1; i < size; ++i) {
+            const auto value = data[i];
+            const auto key = radix_key(value);
+            std::size_t j = i;
+            for (; j > 0 && key < radix_key(data[j - 1]); --j) {
+                data[j] = data[j - 1];
+            }
+            data[j] = value;
+        }
+        return;
+    }
+
+    const auto d = static_cast<unsigned>(digit);
+
+    std::array<std::size_t, Config::n_buckets> counts{};
+    for (std::size_t i = 0; i < size; ++i) {
+        ++counts[Config::digit(radix_key(data[i]), d)];
+    }
+
+    std::array<std::size_t, Config::n_buckets> heads;
+    std::array<std::size_t, Config::n_buckets> tails;
+    std::size_t sum = 0;
+    for (std::size_t b = 0; b < Config::n_buckets; ++b) {
+        heads[b] = sum;
+        sum += counts[b];
+        tails[b] = sum;
+    }
+
+    for (std::size_t b = 0; b < Config::n_buckets; ++b) {
+        while (heads[b] < tails[b]) {
+            auto value = data[heads[b]];
+            auto target = Config::digit(radix_key(value), d);
+            while (target != b) {
+                std::swap(value, data[heads[target]++]);
+                target = Config::digit(radix_key(value), d);
+            }
+            data[heads[b]++] = value;
+        }
+    }
+
+    std::size_t first = 0;
+    for (std::size_t b = 0; b < Config::n_buckets; ++b) {
+        msd_radix_sort_impl(data + first, counts[b], digit - 1);
+        first += counts[b];
+    }
+}
+
+/**
+ * Whether @Iterator is known to walk contiguous, mutable memory: a pointer, or an iterator of std::vector. Other random
+ * access iterators, such as those of std::deque, are rejected rather than guessed at.
+ */
+template <typename Iterator, typename T = typename std::iterator_traits<Iterator>::value_type>
+struct is_contiguous_iterator
+  : std::disjunction<std::is_same<Iterator, T*>, std::is_same<Iterator, typename std::vector<T>::iterator>>
+{
+};
+
+template <typename RandomAccessIterator>
+constexpr void radix_sort_requirements()
+{
+    using T = typename std::iterator_traits<RandomAccessIterator>::value_type;
+    static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value && sizeof(T) <= 8,
+                  "Radix sort only supports integer and floating point keys of up to 64 bits");
+    static_assert(is_contiguous_iterator<RandomAccessIterator>::value,
+                  "RandomAccessIterator must be a pointer or a std::vector iterator");
+}
+
+} // namespace internal
+
+/**
+ * In-situ, ascending LSD radix sort for integer and floating point keys, over contiguous memory: pointers (which
+ * std::array iterators are, in the usual standard libraries) or std::vector iterators. Sorts 32-bit keys in three passes of 11-bit digits, after a single histogram pass.
+ *
+ * Complexity: O(n) time, plus a buffer of n entries.
+ */
+template <typename RandomAccessIterator>
+void lsd_radix_sort(RandomAccessIterator begin, RandomAccessIterator end)
+{
+    internal::radix_sort_requirements<RandomAccessIterator>();
+    using T = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+    const auto size = static_cast<std::size_t>(std::distance(begin, end));
+    if (size < 2) {
+        return;
+    }
+
+    T* data = &*begin;
+    std::vector<T> buffer(size);
+    if (internal::lsd_radix_sort_impl(data, buffer.data(), size)) {
+        std::copy(buffer.cbegin(), buffer.cend(), data);
+    }
+}
+
+/**
+ * In-situ, ascending MSD radix sort (American flag sort) for integer and floating point keys, over contiguous memory.
+ * Uses no buffer: preferable to lsd_radix_sort for large ranges where memory is tight.
+ *
+ * Complexity: O(n * key bits / digit bits) time, O(key bits / digit bits) recursion depth.
+ */
+template <typename RandomAccessIterator>
+void msd_radix_sort(RandomAccessIterator begin, RandomAccessIterator end)
+{
+    internal::radix_sort_requirements<RandomAccessIterator>();
+    using T = typename std::iterator_traits<RandomAccessIterator>::value_type;
+
+    const auto size = static_cast<std::size_t>(std::distance(begin, end));
+    if (size < 2) {
+        return;
+    }
+    internal::msd_radix_sort_impl(&*begin, size, internal::radix_config<T, 8>::n_digits - 1);
+}
+
+/// In-situ, ascending radix sort for integer and floating point keys, over contiguous memory
+template <typename RandomAccessIterator>
+void radix_sort(RandomAccessIterator begin, RandomAccessIterator end)
+{
+    lsd_radix_sort(begin, end);
+}
+
+} // namespace my
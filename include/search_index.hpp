@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+namespace my
+{
+
+namespace internal
+{
+
+/// Number of trailing 1 bits of @x
+inline unsigned count_trailing_ones(std::size_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return ~x == 0 ? sizeof(x) * CHAR_BIT : static_cast<unsigned>(__builtin_ctzll(~x));
+#else
+    unsigned count = 0;
+    for (; x & 1; x >>= 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+/// Position of the highest 1 bit of @x, which must not be 0
+inline unsigned highest_bit(std::size_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return sizeof(x) * CHAR_BIT - 1 - static_cast<unsigned>(__builtin_clzll(x));
+#else
+    unsigned bit = 0;
+    while (x >>= 1) {
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+/// Hints the processor to fetch the cache line at @address. Never faults, even on invalid addresses.
+inline void prefetch([[maybe_unused]] const void* address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#endif
+}
+
+} // namespace internal
+
+/**
+ * Build-once search index over a sorted range, for many lookups against a static table.
+ *
+ * Values are laid out in Eytzinger order: the sorted range is stored as an implicit binary search tree in breadth-first
+ * order, the children of node k being nodes 2k and 2k+1. The first levels of the tree, which every lookup goes
+ * through, share a handful of cache lines, and the nodes a lookup may visit a few levels down are contiguous: they are
+ * prefetched while the current levels are compared. The inner loop is branch-free and runs for the same number of
+ * iterations on every lookup.
+ *
+ * Lookups return ranks: positions in the sorted range the index was built from.
+ */
+template <typename T, typename BinaryPredicate = std::less<T>>
+class eytzinger_index
+{
+  public:
+    /// Number of lookups interleaved by the batched lookup
+    static constexpr std::size_t batch_size = 16;
+
+    /// Builds the index from the range [ @begin , @end ), sorted according to @compare
+    template <typename ForwardIterator>
+    eytzinger_index(ForwardIterator begin, ForwardIterator end, BinaryPredicate compare = BinaryPredicate{})
+        : compare_{compare}, size_{static_cast<std::size_t>(std::distance(begin, end))}
+    {
+        if (size_ == 0) {
+            return;
+        }
+
+        values_.resize(size_ + 1, *begin);
+        build(begin, 1);
+
+        height_ = internal::highest_bit(size_) + 1;
+        last_level_size_ = size_ - ((std::size_t{1} << (height_ - 1)) - 1);
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    /**
+     * Rank of the first value for which @pred is false, in a range partitioned with respect to @pred (as with
+     * std::partition_point). Returns size() if @pred holds for every value.
+     */
+    template <typename UnaryPredicate>
+    std::size_t partition_point(UnaryPredicate pred) const
+    {
+        std::size_t k = 1;
+        for (unsigned level = 1; level < height_; ++level) {
+            internal::prefetch(prefetch_address(k));
+            k = 2 * k + static_cast<std::size_t>(pred(values_[k]));
+        }
+        return rank_of(last_step(k, pred));
+    }
+
+    /// Rank of the first value not less than @key
+    std::size_t lower_bound(const T& key) const
+    {
+        return partition_point([&](const T& value) { return compare_(value, key); });
+    }
+
+    /// Rank of the first value greater than @key
+    std::size_t upper_bound(const T& key) const
+    {
+        return partition_point([&](const T& value) { return !compare_(key, value); });
+    }
+
+    /**
+     * Batched lower_bound: writes the rank of the first value not less than each key of [ @keys_begin , @keys_end )
+     * to @out, and returns the end of the output. Lookups are run in groups of batch_size, one level at a time, so
+     * that their cache misses overlap instead of following each other.
+     */
+    template <typename InputIterator, typename OutputIterator>
+    OutputIterator lower_bound(InputIterator keys_begin, InputIterator keys_end, OutputIterator out) const
+    {
+        std::array<T, batch_size> keys;
+        std::array<std::size_t, batch_size> nodes;
+
+        while (keys_begin != keys_end) {
+            std::size_t n_keys = 0;
+            for (; n_keys < batch_size && keys_begin != keys_end; ++n_keys, ++keys_begin) {
+                keys[n_keys] = *keys_begin;
+                nodes[n_keys] = 1;
+            }
+
+            for (unsigned level = 1; level < height_; ++level) {
+                for (std::size_t i = 0; i < n_keys; ++i) {
+                    const auto k = nodes[i];
+                    internal::prefetch(prefetch_address(k));
+                    nodes[i] = 2 * k + static_cast<std::size_t>(compare_(values_[k], keys[i]));
+                }
+            }
+
+            for (std::size_t i = 0; i < n_keys; ++i, ++out) {
+                const auto& key = keys[i];
+                *out = rank_of(last_step(nodes[i], [&](const T& value) { return compare_(value, key); }));
+            }
+        }
+        return out;
+    }
+
+  private:
+    /// In-order traversal of the subtree at @node, filled with consecutive values from @it
+    template <typename ForwardIterator>
+    void build(ForwardIterator& it, std::size_t node)
+    {
+        if (node > size_) {
+            return;
+        }
+        build(it, 2 * node);
+        values_[node] = *it;
+        ++it;
+        build(it, 2 * node + 1);
+    }
+
+    /**
+     * Step on the deepest level, which may be incomplete. Missing nodes count as values for which the predicate holds,
+     * so that every lookup takes the same number of steps.
+     */
+    template <typename UnaryPredicate>
+    std::size_t last_step(std::size_t k, UnaryPredicate pred) const
+    {
+        if (size_ == 0) {
+            return 0;
+        }
+        const bool right = (k > size_) | static_cast<bool>(pred(values_[std::min(k, size_)]));
+        return 2 * k + static_cast<std::size_t>(right);
+    }
+
+    /**
+     * Rank of the node where a lookup that ended on node @k turned left last, or size() if it never did. Ranks are
+     * computed rather than stored, to save a cache miss per lookup: the in-order position of the node in a perfect tree
+     * of the same height, minus the missing last-level nodes that would come before it.
+     */
+    std::size_t rank_of(std::size_t k) const
+    {
+        k >>= internal::count_trailing_ones(k) + 1;
+        if (k == 0) {
+            return size_;
+        }
+
+        const auto depth = internal::highest_bit(k);
+        const auto perfect_rank = ((2 * (k - (std::size_t{1} << depth)) + 1) << (height_ - 1 - depth)) - 1;
+        const auto last_level_before = (perfect_rank + 1) / 2;
+        return perfect_rank - (last_level_before > last_level_size_ ? last_level_before - last_level_size_ : 0);
+    }
+
+    /// First of the nodes a few levels below node @k: as many as fit in a cache line are contiguous
+    const void* prefetch_address(std::size_t k) const
+    {
+        constexpr std::size_t nodes_per_line = std::max<std::size_t>(1, 64 / sizeof(T));
+        return values_.data() + std::min(k * nodes_per_line, size_);
+    }
+
+    BinaryPredicate compare_;
+    std::size_t size_;
+    unsigned height_ = 0;             // Number of levels of the tree
+    std::size_t last_level_size_ = 0; // Number of nodes on the deepest level
+    std::vector<T> values_;           // 1-based, in Eytzinger order
+};
+
+} // namespace my
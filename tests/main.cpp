@@ -3,6 +3,10 @@
 // Project includes
 #include "test_bigint.hpp"
 #include "test_algorithms.hpp"
+#include "test_radix_sort.hpp"
+#include "test_search_index.hpp"
+#include "test_external_sort.hpp"
+#include "test_integer_loader.hpp"
 
 // External library includes
 #include <doctest/doctest.h>
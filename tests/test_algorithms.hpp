@@ -4,13 +4,54 @@
 
 #include "include/algorithms.hpp"
 
+#include <array>
 #include <vector>
 #include <list>
 #include <forward_list>
+#include <atomic>
 #include <execution>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+// Set by the build, so that the tests find their data from any working directory
+#ifndef TEST_DATA_DIR
+#define TEST_DATA_DIR "data"
+#endif
 
 TEST_CASE_TEMPLATE("algortihms.hpp", TContainer, std::vector<int>, std::list<int>, std::forward_list<int>)
 {
+    constexpr bool random_access = std::is_convertible<
+      typename std::iterator_traits<typename TContainer::iterator>::iterator_category,
+      std::random_access_iterator_tag>::value;
+
+    // Deterministic values in [0, modulo), scattered by a prime stride so that every residue shows up
+    const auto scattered = [](std::size_t size, int modulo) {
+        std::vector<int> values(size);
+        std::generate(values.begin(), values.end(), [modulo, n = 0]() mutable { return (n++ * 7919) % modulo; });
+        return values;
+    };
+
+    // Input large enough for the parallel algorithms to split into several tasks
+    const auto parallel_input = [&]() {
+        return scattered(static_cast<std::size_t>(my::internal::AlgoConfig::PARALLEL_MIN_SIZE * 4.3), 1000);
+    };
+
+    // Overrides AlgoConfig::PARALLEL_TASKS for the enclosing scope, restoring it even if a check throws
+    struct scoped_parallel_tasks
+    {
+        explicit scoped_parallel_tasks(unsigned tasks)
+          : previous(std::exchange(my::internal::AlgoConfig::PARALLEL_TASKS, tasks))
+        {}
+        scoped_parallel_tasks(const scoped_parallel_tasks&) = delete;
+        scoped_parallel_tasks& operator=(const scoped_parallel_tasks&) = delete;
+        ~scoped_parallel_tasks() { my::internal::AlgoConfig::PARALLEL_TASKS = previous; }
+
+        const unsigned previous;
+    };
+
     SUBCASE("sorted_partition_point")
     {
         // Empty case
@@ -48,6 +89,27 @@ TEST_CASE_TEMPLATE("algortihms.hpp", TContainer, std::vector<int>, std::list<int
         CHECK_EQ(it4, std::cend(data));
     }
 
+    SUBCASE("gallop_partition_point")
+    {
+        const TContainer c{};
+        CHECK_EQ(my::gallop_partition_point(std::cbegin(c), std::cend(c), [](auto x) { return x > 3; }), std::cend(c));
+
+        std::vector<int> arr(300);
+        std::iota(arr.begin(), arr.end(), 0);
+        const TContainer data(arr.cbegin(), arr.cend());
+
+        // Every partition point, including both ends
+        for (int p = 0; p <= 300; ++p) {
+            std::ptrdiff_t n_calls = 0;
+            const auto it = my::gallop_partition_point(std::cbegin(data), std::cend(data), [&](auto x) {
+                ++n_calls;
+                return x < p;
+            });
+            CHECK_EQ(std::distance(std::cbegin(data), it), p);
+            CHECK_LE(n_calls, 2 * static_cast<std::ptrdiff_t>(my::internal::floor_log2(p + 1) + 1));
+        }
+    }
+
     SUBCASE("selection_sort")
     {
         TContainer empty_c{};
@@ -86,6 +148,68 @@ TEST_CASE_TEMPLATE("algortihms.hpp", TContainer, std::vector<int>, std::list<int
         }
     }
 
+    SUBCASE("sorting network")
+    {
+        std::mt19937 gen(10);
+        std::uniform_int_distribution<int> dist(-20, 20);
+        for (std::ptrdiff_t size = 0; size <= my::internal::SORTING_NETWORK_MAX_SIZE; ++size) {
+            TContainer a(size);
+            std::generate(std::begin(a), std::end(a), [&] { return dist(gen); });
+            if (size > 0) {
+                *std::begin(a) = std::numeric_limits<int>::max(); // Same value as the padding
+            }
+
+            std::vector<int> expected(std::begin(a), std::end(a));
+            std::sort(std::begin(expected), std::end(expected));
+            my::internal::sorting_network_sort(std::begin(a), size, std::less<int>{});
+            CHECK(std::equal(std::begin(a), std::end(a), std::begin(expected), std::end(expected)));
+
+            std::reverse(std::begin(expected), std::end(expected));
+            my::internal::sorting_network_sort(std::begin(a), size, std::greater<>{});
+            CHECK(std::equal(std::begin(a), std::end(a), std::begin(expected), std::end(expected)));
+        }
+
+        constexpr auto inf = std::numeric_limits<double>::infinity();
+        std::vector<double> d{2.5, inf, -1.0, 0.0, -inf};
+        my::internal::sorting_network_sort(std::begin(d), static_cast<std::ptrdiff_t>(d.size()), std::less<>{});
+        CHECK_EQ(d, std::vector<double>{-inf, -1.0, 0.0, 2.5, inf});
+    }
+
+    SUBCASE("merge (stability)")
+    {
+        // Keys are compared without the low digits, which tell entries of equal keys apart
+        const auto by_tens = [](int a, int b) { return a / 10 < b / 10; };
+
+        const TContainer left{10, 20, 21, 30};
+        const TContainer right{25, 26, 31, 35};
+        TContainer merged(8, 0);
+        my::merge(std::cbegin(left), std::cend(left), std::cbegin(right), std::cend(right), std::begin(merged),
+                  by_tens);
+        CHECK_EQ(merged, TContainer{10, 20, 21, 25, 26, 30, 31, 35});
+
+        // Ties keep the input order, sequential and parallel
+        const std::size_t arrsize = my::internal::AlgoConfig::PARALLEL_MIN_SIZE * 2.1;
+        std::vector<int> arr(arrsize, 0);
+        std::mt19937 gen(17);
+        for (std::size_t i = 0; i < arrsize; ++i) {
+            arr[i] = static_cast<int>(gen() % 50 * 100000 + i);
+        }
+        const auto by_key = [](int a, int b) { return a / 100000 < b / 100000; };
+
+        std::vector<int> expected(arr);
+        std::stable_sort(expected.begin(), expected.end(), by_key);
+
+        const TContainer data(arr.cbegin(), arr.cend());
+        TContainer outp(arrsize, {});
+        my::merge_sort(std::cbegin(data), std::cend(data), std::begin(outp), by_key);
+        CHECK(std::equal(std::cbegin(outp), std::cend(outp), expected.cbegin(), expected.cend()));
+
+        if constexpr (random_access) {
+            my::merge_sort(std::execution::par, std::cbegin(data), std::cend(data), std::begin(outp), by_key);
+            CHECK(std::equal(std::cbegin(outp), std::cend(outp), expected.cbegin(), expected.cend()));
+        }
+    }
+
     SUBCASE("merge_sort")
     {
         const std::size_t arrsize = my::internal::AlgoConfig::MERGESORT_MIN_SIZE * 2.1;
@@ -112,6 +236,260 @@ TEST_CASE_TEMPLATE("algortihms.hpp", TContainer, std::vector<int>, std::list<int
         CHECK_EQ(outp, TContainer{});
     }
 
+    SUBCASE("merge_sort_buffered")
+    {
+        const std::size_t arrsize = my::internal::AlgoConfig::MERGESORT_MIN_SIZE * 4.3;
+        std::vector<int> arr(arrsize, 0);
+        std::iota(arr.begin(), arr.end(), 0);
+
+        TContainer asc(arr.cbegin(), arr.cend());
+        TContainer des(arr.crbegin(), arr.crend());
+        TContainer buffer(arrsize, {});
+
+        // Ascending
+        auto outp = TContainer(arrsize, {});
+        my::merge_sort_buffered(std::cbegin(des), std::cend(des), std::begin(outp), std::begin(buffer));
+        CHECK_EQ(asc, outp);
+
+        // Descending, with a buffer of a different container type
+        std::vector<int> vector_buffer(arrsize, 0);
+        my::merge_sort_buffered(std::cbegin(asc), std::cend(asc), std::begin(outp), vector_buffer.begin(),
+                                std::greater<int>{});
+        CHECK_EQ(des, outp);
+
+        // Repeated values
+        TContainer rep{5, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5};
+        TContainer rep_out(rep);
+        my::merge_sort_buffered(std::cbegin(rep), std::cend(rep), std::begin(rep_out), std::begin(buffer));
+        CHECK_EQ(rep_out, TContainer{1, 1, 2, 3, 4, 5, 5, 5, 5, 6, 9});
+    }
+
+    SUBCASE("task pool")
+    {
+        // Nested calls run every task exactly once
+        std::vector<std::atomic<int>> runs(64);
+        my::internal::parallel_for(8, [&](unsigned outer) {
+            const auto quarter = [&](unsigned first) {
+                my::internal::parallel_for(4, [&](unsigned i) { ++runs[outer * 8 + first + i]; });
+            };
+            my::internal::fork_join([&] { quarter(0); }, [&] { quarter(4); });
+        });
+        CHECK(std::all_of(runs.cbegin(), runs.cend(), [](const auto& n) { return n == 1; }));
+
+        // Exceptions reach the caller once every task has finished
+        std::atomic<int> finished{0};
+        CHECK_THROWS_AS(my::internal::fork_join([] { throw std::runtime_error("forked"); }, [&] { ++finished; }),
+                        std::runtime_error);
+        CHECK_THROWS_AS(my::internal::parallel_for(6,
+                                                   [&](unsigned i) {
+                                                       if (i == 3) {
+                                                           throw std::runtime_error("task");
+                                                       }
+                                                       ++finished;
+                                                   }),
+                        std::runtime_error);
+        CHECK_EQ(finished, 6);
+    }
+
+    SUBCASE("merge_sort (parallel)")
+    {
+        const auto arr = parallel_input();
+
+        std::vector<int> expected(arr);
+        std::sort(expected.begin(), expected.end());
+
+        const TContainer data(arr.cbegin(), arr.cend());
+        TContainer outp(arr.size(), {});
+
+        const scoped_parallel_tasks tasks(4);
+
+        if constexpr (random_access) {
+            // Ascending
+            my::merge_sort(std::execution::par, std::cbegin(data), std::cend(data), std::begin(outp));
+            CHECK(std::equal(std::cbegin(outp), std::cend(outp), expected.cbegin(), expected.cend()));
+
+            // Descending
+            my::merge_sort(std::execution::par_unseq, std::cbegin(data), std::cend(data), std::begin(outp),
+                           std::greater<int>{});
+            CHECK(std::equal(std::cbegin(outp), std::cend(outp), expected.crbegin(), expected.crend()));
+        }
+
+        // Sequenced policy
+        my::merge_sort(std::execution::seq, std::cbegin(data), std::cend(data), std::begin(outp));
+        CHECK(std::equal(std::cbegin(outp), std::cend(outp), expected.cbegin(), expected.cend()));
+    }
+
+    SUBCASE("pivot policies")
+    {
+        const auto arr = scattered(my::internal::AlgoConfig::QUICKSORT_MIN_SIZE * 2.1, 100);
+
+        std::vector<int> expected(arr);
+        std::sort(expected.begin(), expected.end());
+
+        const auto check_policy = [&](auto policy) {
+            using Policy = decltype(policy);
+
+            TContainer data(arr.cbegin(), arr.cend());
+            my::quick_sort<Policy>(std::begin(data), std::end(data));
+            CHECK(std::equal(std::cbegin(data), std::cend(data), expected.cbegin(), expected.cend()));
+
+            TContainer small{4, 1, 3, 6, 2, 5};
+            auto it = my::nth_element<Policy>(std::begin(small), std::end(small), 2);
+            CHECK_EQ(*it, 3);
+        };
+
+        check_policy(my::pivot::first{});
+        check_policy(my::pivot::last{});
+        check_policy(my::pivot::sample_3{});
+        check_policy(my::pivot::random{});
+        check_policy(my::pivot::ninther{});
+        check_policy(my::pivot::median_of_medians{});
+        check_policy(my::pivot::floyd_rivest{});
+        check_policy(my::pivot::runtime{});
+
+        // Median of medians lands between the 30th and 70th percentiles
+        TContainer data(arr.cbegin(), arr.cend());
+        std::less<int> less;
+        const auto pivot = *my::pivot::median_of_medians::choose(std::begin(data), std::end(data), less);
+        CHECK_GE(pivot, expected[expected.size() * 3 / 10]);
+        CHECK_LE(pivot, expected[expected.size() * 7 / 10]);
+
+        // Seeded random pivots are reproducible
+        std::vector<int> picks;
+        for (int run = 0; run < 2; ++run) {
+            my::pivot::random::seed(42);
+            for (int i = 0; i < 10; ++i) {
+                picks.push_back(*my::pivot::random::choose(std::cbegin(data), std::cend(data), less));
+            }
+        }
+        CHECK(std::equal(picks.cbegin(), picks.cbegin() + 10, picks.cbegin() + 10));
+    }
+
+    SUBCASE("tim_sort")
+    {
+        if constexpr (random_access) {
+            TContainer empty_c{};
+            my::tim_sort(std::begin(empty_c), std::end(empty_c));
+            CHECK_EQ(empty_c, TContainer{});
+
+            const std::size_t arrsize = my::internal::AlgoConfig::MERGESORT_MIN_SIZE * 43;
+            std::mt19937 gen(16);
+
+            // Random, presorted, reversed, sawtooth and nearly sorted inputs
+            std::vector<std::vector<int>> inputs(5, std::vector<int>(arrsize));
+            std::generate(inputs[0].begin(), inputs[0].end(), [&] { return static_cast<int>(gen() % 1000); });
+            std::iota(inputs[1].begin(), inputs[1].end(), 0);
+            std::iota(inputs[2].rbegin(), inputs[2].rend(), 0);
+            std::generate(inputs[3].begin(), inputs[3].end(), [n = 0]() mutable { return n++ % 300; });
+            inputs[4] = inputs[1];
+            for (int i = 0; i < 20; ++i) {
+                std::swap(inputs[4][gen() % arrsize], inputs[4][gen() % arrsize]);
+            }
+
+            for (const auto& input : inputs) {
+                TContainer c(input.cbegin(), input.cend());
+                my::tim_sort(std::begin(c), std::end(c));
+                CHECK(std::is_sorted(std::cbegin(c), std::cend(c)));
+                CHECK(std::is_permutation(std::cbegin(c), std::cend(c), input.cbegin(), input.cend()));
+
+                my::tim_sort(std::begin(c), std::end(c), std::greater<>{});
+                CHECK(std::is_sorted(std::cbegin(c), std::cend(c), std::greater<>{}));
+            }
+
+            // Stability: values are ordered by key only, and their original position must be kept among equal keys
+            std::vector<std::pair<int, int>> pairs(arrsize);
+            for (std::size_t i = 0; i < arrsize; ++i) {
+                pairs[i] = {inputs[i % 4][i] % 10, static_cast<int>(i)};
+            }
+            auto expected = pairs;
+            const auto by_key = [](const auto& a, const auto& b) { return a.first < b.first; };
+            std::stable_sort(expected.begin(), expected.end(), by_key);
+            my::tim_sort(pairs.begin(), pairs.end(), by_key);
+            CHECK_EQ(pairs, expected);
+        }
+    }
+
+    SUBCASE("merge_sort (node splicing)")
+    {
+        if constexpr (!std::is_same_v<TContainer, std::vector<int>>) {
+            const auto arr = scattered(my::internal::AlgoConfig::MERGESORT_MIN_SIZE * 2.1, 100);
+
+            std::vector<int> expected(arr);
+            std::sort(expected.begin(), expected.end());
+
+            TContainer data(arr.cbegin(), arr.cend());
+            std::vector<const int*> nodes;
+            std::for_each(std::cbegin(data), std::cend(data), [&](const auto& x) { nodes.push_back(&x); });
+
+            // Ascending
+            my::merge_sort(data);
+            CHECK(std::equal(std::cbegin(data), std::cend(data), expected.cbegin(), expected.cend()));
+
+            // No element has been copied
+            std::vector<const int*> sorted_nodes;
+            std::for_each(std::cbegin(data), std::cend(data), [&](const auto& x) { sorted_nodes.push_back(&x); });
+            CHECK(std::is_permutation(nodes.cbegin(), nodes.cend(), sorted_nodes.cbegin(), sorted_nodes.cend()));
+
+            // Descending
+            my::merge_sort(data, std::greater<int>{});
+            CHECK(std::equal(std::cbegin(data), std::cend(data), expected.crbegin(), expected.crend()));
+
+            // Stable: sorting by tens keeps units in their original order
+            TContainer c{31, 12, 33, 14, 35, 16, 37, 18};
+            my::merge_sort(c, [](int a, int b) { return a / 10 < b / 10; });
+            CHECK_EQ(c, TContainer{12, 14, 16, 18, 31, 33, 35, 37});
+
+            // Empty
+            TContainer empty_c{};
+            my::merge_sort(empty_c);
+            CHECK_EQ(empty_c, TContainer{});
+        }
+    }
+
+    SUBCASE("inplace_merge_sort")
+    {
+        if constexpr (random_access) {
+            auto arr = scattered(my::internal::AlgoConfig::INPLACE_MERGESORT_BUFFER_BYTES, 1000);
+
+            std::vector<int> expected(arr);
+            std::sort(expected.begin(), expected.end());
+
+            // Ascending, with runs larger than the scratch buffer
+            TContainer data(arr.cbegin(), arr.cend());
+            my::inplace_merge_sort(std::begin(data), std::end(data));
+            CHECK(std::equal(std::cbegin(data), std::cend(data), expected.cbegin(), expected.cend()));
+
+            // Descending
+            my::inplace_merge_sort(std::begin(data), std::end(data), std::greater<int>{});
+            CHECK(std::equal(std::cbegin(data), std::cend(data), expected.crbegin(), expected.crend()));
+
+            // Stable: sorting by tens keeps units in their original order
+            TContainer c(arr.cbegin(), arr.cend());
+            my::inplace_merge_sort(std::begin(c), std::end(c), [](int a, int b) { return a / 10 < b / 10; });
+
+            std::stable_sort(arr.begin(), arr.end(), [](int a, int b) { return a / 10 < b / 10; });
+            CHECK_EQ(c, TContainer(arr.cbegin(), arr.cend()));
+
+            // A single-entry scratch area: blocks are merged through a buffer of distinct keys, or by rotations when
+            // there are too few distinct keys for it
+            const auto default_bytes = std::exchange(my::internal::AlgoConfig::INPLACE_MERGESORT_BUFFER_BYTES, 1);
+            for (const int modulo : {1000, 100000}) {
+                auto values = scattered(16384, modulo);
+                TContainer d(values.cbegin(), values.cend());
+                my::inplace_merge_sort(std::begin(d), std::end(d), [](int a, int b) { return a / 10 < b / 10; });
+
+                std::stable_sort(values.begin(), values.end(), [](int a, int b) { return a / 10 < b / 10; });
+                CHECK_EQ(d, TContainer(values.cbegin(), values.cend()));
+            }
+            my::internal::AlgoConfig::INPLACE_MERGESORT_BUFFER_BYTES = default_bytes;
+
+            // Empty
+            TContainer empty_c{};
+            my::inplace_merge_sort(std::begin(empty_c), std::end(empty_c));
+            CHECK_EQ(empty_c, TContainer{});
+        }
+    }
+
     SUBCASE("quick_sort")
     {
         const std::size_t arrsize = my::internal::AlgoConfig::QUICKSORT_MIN_SIZE * 2.1;
@@ -141,6 +519,114 @@ TEST_CASE_TEMPLATE("algortihms.hpp", TContainer, std::vector<int>, std::list<int
         CHECK_EQ(asc, des);
     }
 
+    SUBCASE("quick_sort (parallel)")
+    {
+        const auto arr = parallel_input();
+
+        std::vector<int> expected(arr);
+        std::sort(expected.begin(), expected.end());
+
+        const scoped_parallel_tasks tasks(4);
+
+        if constexpr (random_access) {
+            // Ascending
+            TContainer data(arr.cbegin(), arr.cend());
+            my::quick_sort(std::execution::par, std::begin(data), std::end(data));
+            CHECK(std::equal(std::cbegin(data), std::cend(data), expected.cbegin(), expected.cend()));
+
+            // Descending, from sorted input with the worst pivot choice
+            my::quick_sort<my::pivot::first>(std::execution::par_unseq, std::begin(data), std::end(data),
+                                             std::greater<int>{});
+            CHECK(std::equal(std::cbegin(data), std::cend(data), expected.crbegin(), expected.crend()));
+
+            // Random pivots are reproducible once the calling thread is seeded, whichever threads run the tasks.
+            // Two sorts run side by side, so that each may pick up tasks of the other.
+            std::array<long, 2> comparisons{};
+            std::array<TContainer, 2> seeded{TContainer(arr.cbegin(), arr.cend()),
+                                             TContainer(arr.cbegin(), arr.cend())};
+            std::array<std::thread, 2> threads;
+            for (std::size_t i = 0; i < threads.size(); ++i) {
+                threads[i] = std::thread([&, i] {
+                    std::atomic<long> n_compared{0};
+                    my::pivot::random::seed(42);
+                    my::quick_sort<my::pivot::random>(std::execution::par, std::begin(seeded[i]), std::end(seeded[i]),
+                                                      [&](int x, int y) {
+                                                          ++n_compared;
+                                                          return x < y;
+                                                      });
+                    comparisons[i] = n_compared;
+                });
+            }
+            std::for_each(threads.begin(), threads.end(), [](auto& thread) { thread.join(); });
+            CHECK_EQ(comparisons[0], comparisons[1]);
+            for (const auto& sorted : seeded) {
+                CHECK(std::equal(std::cbegin(sorted), std::cend(sorted), expected.cbegin(), expected.cend()));
+            }
+        }
+
+        // Sequenced policy
+        TContainer data(arr.cbegin(), arr.cend());
+        my::quick_sort(std::execution::seq, std::begin(data), std::end(data));
+        CHECK(std::equal(std::cbegin(data), std::cend(data), expected.cbegin(), expected.cend()));
+    }
+
+    SUBCASE("heap_sort")
+    {
+        if constexpr (random_access) {
+            TContainer empty_c{};
+            my::heap_sort(std::begin(empty_c), std::end(empty_c));
+            CHECK_EQ(empty_c, TContainer{});
+
+            TContainer a{1, 8, 9, 13, 6, 13, 10, 13, 0, 18};
+            const TContainer asc{0, 1, 6, 8, 9, 10, 13, 13, 13, 18};
+            const TContainer des{18, 13, 13, 13, 10, 9, 8, 6, 1, 0};
+
+            my::heap_sort(std::begin(a), std::end(a));
+            CHECK_EQ(a, asc);
+
+            my::heap_sort(std::begin(a), std::end(a), std::greater<>{});
+            CHECK_EQ(a, des);
+        }
+    }
+
+    SUBCASE("intro_sort")
+    {
+        if constexpr (random_access) {
+            const std::size_t arrsize = my::internal::AlgoConfig::QUICKSORT_MIN_SIZE * 21;
+            std::vector<int> arr(arrsize, 0);
+            std::iota(arr.begin(), arr.end(), 0);
+
+            TContainer asc(arr.cbegin(), arr.cend());
+            TContainer des(arr.crbegin(), arr.crend());
+
+            // Sorted input with the first element as pivot goes quadratic without the depth limit
+            using Config = my::internal::AlgoConfig;
+            const auto default_pivot =
+              std::exchange(Config::QUICKSORT_PIVOT_CHOICE, Config::QuicksortPivotChoice::FIRST);
+
+            TContainer a(asc);
+            my::intro_sort(std::begin(a), std::end(a));
+            CHECK_EQ(a, asc);
+
+            my::intro_sort(std::begin(a), std::end(a), std::greater<int>{});
+            CHECK_EQ(a, des);
+
+            Config::QUICKSORT_PIVOT_CHOICE = default_pivot;
+
+            // Few distinct keys
+            const auto b_values = scattered(arrsize, 3);
+            TContainer b(b_values.cbegin(), b_values.cend());
+            my::intro_sort(std::begin(b), std::end(b));
+            CHECK(std::is_sorted(std::cbegin(b), std::cend(b)));
+            CHECK_EQ(std::count(std::cbegin(b), std::cend(b), 1), arrsize / 3);
+
+            // Empty
+            TContainer c{};
+            my::intro_sort(std::begin(c), std::end(c));
+            CHECK_EQ(c, TContainer{});
+        }
+    }
+
     SUBCASE("sort_and_count_inversions")
     {
         if constexpr (std::is_convertible<
@@ -168,6 +654,24 @@ TEST_CASE_TEMPLATE("algortihms.hpp", TContainer, std::vector<int>, std::list<int
                 auto invs = my::sort_and_count_inversions(std::cbegin(c), std::cend(c), std::begin(outp));
                 CHECK_EQ(invs, 3);
             }
+            // Equal pairs are not inversions
+            {
+                TContainer c{2, 1, 2, 1};
+                TContainer outp{c};
+                auto invs = my::sort_and_count_inversions(std::cbegin(c), std::cend(c), std::begin(outp));
+                CHECK_EQ(invs, 3);
+                CHECK_EQ(outp, TContainer{1, 1, 2, 2});
+            }
+            // Demo data
+            {
+                std::ifstream file(TEST_DATA_DIR "/inversions-data.txt");
+                REQUIRE(file);
+                const std::vector<unsigned int> data(std::istream_iterator<unsigned int>(file), {});
+                std::vector<unsigned int> outp(data.size(), 0);
+                auto invs = my::sort_and_count_inversions(data.cbegin(), data.cend(), outp.begin());
+                CHECK_EQ(invs, 2407905288);
+                CHECK(std::is_sorted(outp.cbegin(), outp.cend()));
+            }
 
             // Ascending-Ascending
             {
@@ -202,6 +706,87 @@ TEST_CASE_TEMPLATE("algortihms.hpp", TContainer, std::vector<int>, std::list<int
         }
     }
 
+    SUBCASE("count_inversions")
+    {
+        const auto brute_force = [](const auto& values, auto compare) {
+            std::uint64_t count = 0;
+            for (auto i = std::begin(values); i != std::end(values); ++i) {
+                for (auto j = std::next(i); j != std::end(values); ++j) {
+                    count += compare(*j, *i);
+                }
+            }
+            return count;
+        };
+
+        TContainer empty_c{};
+        CHECK_EQ(static_cast<std::uint64_t>(my::count_inversions(std::cbegin(empty_c), std::cend(empty_c))), 0);
+
+        // Small key domains go through the Fenwick tree, large ones through merge-sort
+        std::mt19937 gen(17);
+        for (const int domain : {1, 7, 1000000}) {
+            std::vector<int> values(1000);
+            std::generate(values.begin(), values.end(), [&] { return static_cast<int>(gen() % domain) - domain / 2; });
+            const TContainer c(values.cbegin(), values.cend());
+
+            const auto ascending = my::count_inversions(std::cbegin(c), std::cend(c));
+            CHECK_EQ(static_cast<std::uint64_t>(ascending), brute_force(c, std::less<>{}));
+
+            const auto descending = my::count_inversions(std::cbegin(c), std::cend(c), std::greater<>{});
+            CHECK_EQ(static_cast<std::uint64_t>(descending), brute_force(c, std::greater<>{}));
+
+            const auto custom = my::count_inversions<std::uint64_t>(
+              std::cbegin(c), std::cend(c), [](int a, int b) { return a / 3 < b / 3; });
+            CHECK_EQ(custom, brute_force(c, [](int a, int b) { return a / 3 < b / 3; }));
+
+            CHECK(std::equal(std::cbegin(c), std::cend(c), values.cbegin(), values.cend()));
+
+            if constexpr (std::is_convertible<
+                            typename std::iterator_traits<typename TContainer::iterator>::iterator_category,
+                            std::bidirectional_iterator_tag>::value) {
+                TContainer outp(c);
+                const auto sorted_count = my::sort_and_count_inversions(std::cbegin(c), std::cend(c), std::begin(outp));
+                CHECK_EQ(sorted_count, static_cast<std::uint64_t>(ascending));
+            }
+        }
+
+        // Extreme keys do not overflow the domain computation
+        const TContainer extremes{std::numeric_limits<int>::max(), 0, std::numeric_limits<int>::min(), 0};
+        CHECK_EQ(static_cast<std::uint64_t>(my::count_inversions(std::cbegin(extremes), std::cend(extremes))), 4);
+    }
+
+    SUBCASE("count_inversions (parallel)")
+    {
+        const auto arr = parallel_input();
+
+        std::vector<int> expected(arr);
+        std::sort(expected.begin(), expected.end());
+
+        const TContainer data(arr.cbegin(), arr.cend());
+        TContainer outp(arr.size(), {});
+
+        const auto serial = my::count_inversions(std::cbegin(data), std::cend(data));
+        const auto serial_descending = my::count_inversions(std::cbegin(data), std::cend(data), std::greater<int>{});
+
+        const scoped_parallel_tasks tasks(4);
+
+        if constexpr (random_access) {
+            // Ascending
+            CHECK(my::count_inversions(std::execution::par, std::cbegin(data), std::cend(data)) == serial);
+            CHECK_EQ(my::sort_and_count_inversions(std::execution::par, std::cbegin(data), std::cend(data),
+                                                   std::begin(outp)),
+                     static_cast<std::uint64_t>(serial));
+            CHECK(std::equal(std::cbegin(outp), std::cend(outp), expected.cbegin(), expected.cend()));
+
+            // Descending, with a task count that does not divide the merges evenly
+            const scoped_parallel_tasks uneven_tasks(3);
+            CHECK(my::count_inversions(std::execution::par_unseq, std::cbegin(data), std::cend(data),
+                                       std::greater<int>{}) == serial_descending);
+        }
+
+        // Sequenced policy
+        CHECK(my::count_inversions(std::execution::seq, std::cbegin(data), std::cend(data)) == serial);
+    }
+
     SUBCASE("partition")
     {
         // Empty
@@ -233,6 +818,50 @@ TEST_CASE_TEMPLATE("algortihms.hpp", TContainer, std::vector<int>, std::list<int
         }
     }
 
+    SUBCASE("block_partition")
+    {
+        if constexpr (random_access) {
+            // Empty
+            {
+                TContainer c{};
+                auto pp = my::block_partition(std::begin(c), std::end(c), [](auto x) { return x < 4; });
+                CHECK_EQ(c, TContainer{});
+                CHECK_EQ(pp, std::end(c));
+            }
+            // Several blocks
+            {
+                constexpr auto size = 1001;
+                const auto c_values = scattered(size, size);
+                TContainer c(c_values.cbegin(), c_values.cend());
+                auto pp = my::block_partition(std::begin(c), std::end(c), [](auto x) { return x % 3 == 0; });
+
+                CHECK_EQ(std::distance(std::begin(c), pp), size / 3 + 1);
+                std::for_each(std::begin(c), pp, [](auto x) { CHECK(x % 3 == 0); });
+                std::for_each(pp, std::end(c), [](auto x) { CHECK(x % 3 != 0); });
+
+                std::sort(std::begin(c), std::end(c));
+                CHECK_EQ(std::adjacent_find(std::begin(c), std::end(c), [](auto x, auto y) { return y != x + 1; }),
+                         std::end(c));
+            }
+        }
+    }
+
+    SUBCASE("partition_three_way")
+    {
+        if constexpr (std::is_convertible<
+                        typename std::iterator_traits<typename TContainer::iterator>::iterator_category,
+                        std::bidirectional_iterator_tag>::value) {
+            TContainer c{5, 2, 8, 5, 1, 9, 5, 3};
+            auto [lt, gt] = my::partition_three_way(std::begin(c), std::end(c), 5, std::less<int>{});
+
+            CHECK_EQ(std::distance(std::begin(c), lt), 3);
+            CHECK_EQ(std::distance(lt, gt), 3);
+            std::for_each(std::begin(c), lt, [](auto x) { CHECK(x < 5); });
+            std::for_each(lt, gt, [](auto x) { CHECK(x == 5); });
+            std::for_each(gt, std::end(c), [](auto x) { CHECK(x > 5); });
+        }
+    }
+
     SUBCASE("nth_element")
     {
         const std::size_t arrsize = my::internal::AlgoConfig::QUICKSORT_MIN_SIZE * 2.1;
@@ -263,5 +892,116 @@ TEST_CASE_TEMPLATE("algortihms.hpp", TContainer, std::vector<int>, std::list<int
                 CHECK_EQ(*it, 6 - i);
             }
         }
+
+        // Sorted input with first-entry pivots, and Floyd-Rivest sampling, on a range large enough to sample from
+        {
+            const auto large = scattered(5000, 1000);
+            std::vector<int> expected(large);
+            std::sort(expected.begin(), expected.end());
+
+            for (const std::size_t n : {std::size_t{0}, std::size_t{1234}, std::size_t{4999}}) {
+                TContainer sorted(expected.cbegin(), expected.cend());
+                CHECK_EQ(*my::nth_element<my::pivot::first>(std::begin(sorted), std::end(sorted), n), expected[n]);
+
+                TContainer c(large.cbegin(), large.cend());
+                auto it = my::nth_element<my::pivot::floyd_rivest>(std::begin(c), std::end(c), n);
+                CHECK_EQ(*it, expected[n]);
+                CHECK(std::all_of(std::begin(c), it, [&](int x) { return x <= expected[n]; }));
+                CHECK(std::all_of(it, std::end(c), [&](int x) { return x >= expected[n]; }));
+            }
+        }
+    }
+
+    SUBCASE("nth_elements")
+    {
+        const auto arr = scattered(5000, 1000);
+        std::vector<int> expected(arr);
+        std::sort(expected.begin(), expected.end());
+
+        TContainer c(arr.cbegin(), arr.cend());
+        my::nth_elements(std::begin(c), std::end(c), {4999, 2500, 0, 4500, 4950, 2500});
+        for (const std::size_t n : {0, 2500, 4500, 4950, 4999}) {
+            CHECK_EQ(*std::next(std::begin(c), n), expected[n]);
+        }
+        CHECK(std::all_of(std::begin(c), std::next(std::begin(c), 2500), [&](int x) { return x <= expected[2500]; }));
+        CHECK(std::all_of(std::next(std::begin(c), 4950), std::end(c), [&](int x) { return x >= expected[4950]; }));
+
+        const std::vector<std::size_t> ranks{7, 1, 3};
+        TContainer small{4, 1, 3, 6, 2, 5, 0, 9, 8, 7};
+        my::nth_elements(std::begin(small), std::end(small), ranks.cbegin(), ranks.cend(), std::greater<int>{});
+        CHECK_EQ(*std::next(std::begin(small), 1), 8);
+        CHECK_EQ(*std::next(std::begin(small), 3), 6);
+        CHECK_EQ(*std::next(std::begin(small), 7), 2);
+
+        TContainer empty_c{};
+        my::nth_elements(std::begin(empty_c), std::end(empty_c), {});
+        CHECK_EQ(empty_c, TContainer{});
+    }
+
+    SUBCASE("partial_sort")
+    {
+        const auto arr = scattered(my::internal::AlgoConfig::QUICKSORT_MIN_SIZE * 21, 1000);
+        std::vector<int> expected(arr);
+        std::sort(expected.begin(), expected.end());
+
+        for (const std::size_t k : {std::size_t{0}, std::size_t{1}, std::size_t{50}, arr.size()}) {
+            TContainer c(arr.cbegin(), arr.cend());
+            const auto middle = std::next(std::begin(c), k);
+            my::partial_sort(std::begin(c), middle, std::end(c));
+            CHECK(std::equal(std::begin(c), middle, expected.cbegin(), expected.cbegin() + k));
+            CHECK(std::is_permutation(std::begin(c), std::end(c), arr.cbegin(), arr.cend()));
+        }
+
+        TContainer c(arr.cbegin(), arr.cend());
+        my::partial_sort(std::begin(c), std::next(std::begin(c), 3), std::end(c), std::greater<>{});
+        CHECK(std::equal(std::begin(c), std::next(std::begin(c), 3), expected.crbegin(), expected.crbegin() + 3));
+    }
+
+    SUBCASE("partial_sort_copy")
+    {
+        const TContainer c{4, 1, 3, 6, 2, 5, 0, 9, 8, 7};
+
+        std::vector<int> top3(3);
+        auto out_end = my::partial_sort_copy(std::begin(c), std::end(c), top3.begin(), top3.end());
+        CHECK_EQ(out_end, top3.end());
+        CHECK_EQ(top3, std::vector<int>{0, 1, 2});
+
+        out_end = my::partial_sort_copy(std::begin(c), std::end(c), top3.begin(), top3.end(), std::greater<>{});
+        CHECK_EQ(top3, std::vector<int>{9, 8, 7});
+
+        std::vector<int> all(15, -1);
+        out_end = my::partial_sort_copy(std::begin(c), std::end(c), all.begin(), all.end());
+        CHECK_EQ(out_end, all.begin() + 10);
+        CHECK(std::is_sorted(all.begin(), out_end));
+        CHECK_EQ(all[10], -1);
+
+        std::istringstream stream("4 1 3 6 2 5 0 9 8 7");
+        out_end = my::partial_sort_copy(
+          std::istream_iterator<int>(stream), std::istream_iterator<int>(), top3.begin(), top3.end());
+        CHECK_EQ(top3, std::vector<int>{0, 1, 2});
+    }
+
+    SUBCASE("top_k")
+    {
+        const TContainer c{4, 1, 3, 6, 2, 5, 0, 9, 8, 7};
+
+        my::top_k<int> smallest(4);
+        smallest.push(std::begin(c), std::end(c));
+        CHECK_EQ(smallest.size(), 4);
+        CHECK_EQ(smallest.sorted(), std::vector<int>{0, 1, 2, 3});
+
+        my::top_k<int, std::greater<int>> largest(3);
+        for (int i = 0; i < 100000; ++i) {
+            largest.push((i * 7919) % 100003);
+        }
+        CHECK_EQ(largest.sorted(), std::vector<int>{100002, 100001, 100000});
+
+        my::top_k<int> few(20);
+        few.push(std::begin(c), std::end(c));
+        CHECK_EQ(few.size(), 10);
+
+        my::top_k<int> none(0);
+        none.push(std::begin(c), std::end(c));
+        CHECK(none.sorted().empty());
     }
-}
\ No newline at end of file
+}
@@ -2,10 +2,32 @@
 #include <doctest/doctest.h>
 #include "include/bigint.hpp"
 
-TEST_CASE_TEMPLATE("bigint.hpp", WORD, std::uint8_t, unsigned short, unsigned long)
+#include <cmath>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+TEST_CASE_TEMPLATE("bigint.hpp", WORD, std::uint8_t, unsigned short, unsigned int, unsigned long, unsigned long long)
 {
     using INT = my::big_uint<WORD>;
 
+    // Numbers of exactly @size digits: random ones drawn from @seed, and ones with every bit set
+    const auto random_int = [](std::size_t size, std::uint64_t seed) {
+        REQUIRE(size > 0);
+        std::mt19937_64 gen(seed);
+        const auto top_digit = static_cast<WORD>(gen() | 1);
+        std::vector<WORD> digits(size - 1);
+        std::generate(digits.begin(), digits.end(), [&] { return static_cast<WORD>(gen()); });
+        digits.push_back(top_digit);
+        return INT(digits.cbegin(), digits.cend());
+    };
+    const auto all_ones = [](std::size_t size) {
+        const std::vector<WORD> digits(size, std::numeric_limits<WORD>::max());
+        return INT(digits.cbegin(), digits.cend());
+    };
+
     SUBCASE("IO")
     {
         CHECK_THROWS_AS(([] { return INT{"this is not a number!"}; }()), std::invalid_argument);
@@ -150,6 +172,50 @@ TEST_CASE_TEMPLATE("bigint.hpp", WORD, std::uint8_t, unsigned short, unsigned lo
         const INT expected6{"12345678965216435645"};
         CHECK_EQ(a6 - b6, expected6);
     }
+    SUBCASE("In-place addition and subtraction")
+    {
+        const INT a{"683411624631216543135135123"};
+        const INT b{"12345678965216435645"};
+        const INT sum{"683411636976895508351570768"};
+
+        INT c = a;
+        c += b;
+        CHECK_EQ(c, sum);
+        c -= b;
+        CHECK_EQ(c, a);
+        c -= a;
+        CHECK_EQ(c, INT{"0"});
+
+        // Shorter left-hand side
+        INT d = b;
+        d += a;
+        CHECK_EQ(d, sum);
+
+        // Carry and borrow across every digit
+        const INT max64{"18446744073709551615"};
+        const INT pow64{"18446744073709551616"};
+        INT e = max64;
+        e += INT{"1"};
+        CHECK_EQ(e, pow64);
+        e -= INT{"1"};
+        CHECK_EQ(e, max64);
+
+        // Aliasing
+        INT f = b;
+        f += f;
+        CHECK_EQ(f, INT{"24691357930432871290"});
+        f -= f;
+        CHECK_EQ(f, INT{"0"});
+
+        // Binary operators leave their operands untouched
+        const auto a_digits = a.digits_;
+        const auto b_digits = b.digits_;
+        CHECK_EQ(a + b, sum);
+        CHECK_EQ(b + a, sum);
+        CHECK_EQ(sum - b, a);
+        CHECK_EQ(a.digits_, a_digits);
+        CHECK_EQ(b.digits_, b_digits);
+    }
     SUBCASE("Product")
     {
         const INT a1{"0"};
@@ -198,4 +264,93 @@ TEST_CASE_TEMPLATE("bigint.hpp", WORD, std::uint8_t, unsigned short, unsigned lo
                             "044893204848617875072216249073013374895871952806582723184"};
         CHECK_EQ(a9 * b9, expected9);
     }
+    SUBCASE("Product (Karatsuba)")
+    {
+        auto& min_size = my::internal::BigintConfig::KARATSUBA_MIN_SIZE;
+        const auto default_min_size = min_size;
+
+        const std::pair<std::size_t, std::size_t> sizes[] = {{1, 1}, {2, 2}, {7, 7}, {16, 15}, {33, 33}, {64, 3},
+                                                             {100, 37}, {37, 100}, {129, 128}, {250, 61}};
+        for (const auto& [lhs_size, rhs_size] : sizes) {
+            for (const auto& [lhs, rhs] : {std::pair{random_int(lhs_size, 23), random_int(rhs_size, 24)},
+                                           std::pair{all_ones(lhs_size), all_ones(rhs_size)}}) {
+                min_size = std::numeric_limits<std::size_t>::max();
+                const auto expected = lhs * rhs;
+
+                for (const std::size_t karatsuba_min_size : {2, 3, 8}) {
+                    min_size = karatsuba_min_size;
+                    CHECK_EQ(lhs * rhs, expected);
+                }
+            }
+        }
+
+        min_size = 2;
+        const INT a{"3141592653589793238462643383279502884197169399375105820974944592"};
+        const INT b{"2718281828459045235360287471352662497757247093699959574966967627"};
+        const INT expected{"8539734222673567065463550869546574495034888535765114961879601127067743"
+                           "044893204848617875072216249073013374895871952806582723184"};
+        CHECK_EQ(a * b, expected);
+
+        min_size = default_min_size;
+    }
+    SUBCASE("Product (Toom-Cook)")
+    {
+        using Config = my::internal::BigintConfig;
+        const auto default_sizes =
+          std::tuple{Config::KARATSUBA_MIN_SIZE, Config::TOOM3_MIN_SIZE, Config::TOOM4_MIN_SIZE};
+
+        const std::pair<std::size_t, std::size_t> sizes[] = {{9, 9},     {10, 10},  {11, 11},   {16, 16}, {17, 17},
+                                                             {18, 18},   {19, 19},  {50, 49},   {97, 97}, {301, 300},
+                                                             {1000, 20}, {20, 700}, {400, 150}, {1, 400}};
+        for (const auto& [lhs_size, rhs_size] : sizes) {
+            for (const auto& [lhs, rhs] : {std::pair{random_int(lhs_size, 24), random_int(rhs_size, 25)},
+                                           std::pair{all_ones(lhs_size), all_ones(rhs_size)}}) {
+                Config::KARATSUBA_MIN_SIZE = std::numeric_limits<std::size_t>::max();
+                const auto expected = lhs * rhs;
+
+                // Toom-3 only, Toom-4 only, and both over Karatsuba
+                for (const auto& [toom3_min_size, toom4_min_size] :
+                     {std::pair<std::size_t, std::size_t>{2, 10000}, {10000, 2}, {9, 40}}) {
+                    Config::KARATSUBA_MIN_SIZE = 4;
+                    Config::TOOM3_MIN_SIZE = toom3_min_size;
+                    Config::TOOM4_MIN_SIZE = toom4_min_size;
+                    CHECK_EQ(lhs * rhs, expected);
+                }
+            }
+        }
+
+        std::tie(Config::KARATSUBA_MIN_SIZE, Config::TOOM3_MIN_SIZE, Config::TOOM4_MIN_SIZE) = default_sizes;
+    }
+    SUBCASE("Product (NTT)")
+    {
+        using Config = my::internal::BigintConfig;
+        const auto default_sizes = std::tuple{Config::KARATSUBA_MIN_SIZE, Config::NTT_MIN_SIZE};
+
+        const std::pair<std::size_t, std::size_t> sizes[] = {{2, 2},   {3, 2},     {17, 17},  {64, 64},
+                                                             {100, 3}, {300, 299}, {20, 700}, {1000, 1000}};
+        for (const auto& [lhs_size, rhs_size] : sizes) {
+            for (const auto& [lhs, rhs] : {std::pair{random_int(lhs_size, 25), random_int(rhs_size, 26)},
+                                           std::pair{all_ones(lhs_size), all_ones(rhs_size)}}) {
+                // Schoolbook products as the reference
+                Config::KARATSUBA_MIN_SIZE = std::numeric_limits<std::size_t>::max();
+                const auto expected = lhs * rhs;
+                const auto expected_square = lhs * INT(lhs);
+
+                Config::KARATSUBA_MIN_SIZE = 2;
+                Config::NTT_MIN_SIZE = 2;
+                CHECK_EQ(lhs * rhs, expected);
+                CHECK_EQ(lhs * lhs, expected_square);
+            }
+        }
+
+        std::tie(Config::KARATSUBA_MIN_SIZE, Config::NTT_MIN_SIZE) = default_sizes;
+
+        // Products of coefficients stay below the product of the three primes, for transforms they can compute
+        for (const std::size_t bits : {64, 1 << 20, 1 << 26, 1 << 28}) {
+            const auto plan = my::internal::plan_ntt(bits, bits);
+            CHECK_GE(plan.size, 2 * (bits / 32));
+            CHECK_LE(2 * plan.chunk_bits + static_cast<unsigned>(std::log2(plan.size)), 87);
+        }
+        CHECK_EQ(my::internal::plan_ntt(std::size_t{1} << 31, std::size_t{1} << 31).size, 0);
+    }
 }
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <doctest/doctest.h>
+
+#include "include/external_sort.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+TEST_CASE_TEMPLATE("external_sort.hpp", T, std::int32_t, std::uint64_t, double)
+{
+    namespace fs = std::filesystem;
+
+    const auto directory = fs::temp_directory_path() / "my_external_sort_test";
+    fs::create_directories(directory);
+    const auto input = directory / "input";
+    const auto output = directory / "output";
+
+    const auto write_file = [](const fs::path& path, const std::vector<T>& values) {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    };
+    const auto read_file = [](const fs::path& path) {
+        std::vector<T> values(fs::file_size(path) / sizeof(T));
+        std::ifstream file(path, std::ios::binary);
+        file.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(T));
+        return values;
+    };
+    const auto temp_files_left = [&] {
+        return std::count_if(fs::directory_iterator(directory), fs::directory_iterator(), [&](const auto& entry) {
+            return entry.path() != input && entry.path() != output;
+        });
+    };
+
+    std::mt19937_64 gen(19);
+    std::vector<T> data(20000);
+    std::generate(data.begin(), data.end(), [&] { return static_cast<T>(gen() % 5000); });
+    write_file(input, data);
+
+    std::vector<T> expected(data);
+    std::sort(expected.begin(), expected.end());
+
+    my::external_sort_config config;
+    config.temp_directory = directory;
+    config.memory_budget = 1000 * sizeof(T);
+
+    SUBCASE("Several merge passes")
+    {
+        for (const bool async_io : {true, false}) {
+            config.async_io = async_io;
+            const auto stats = my::external_sort<T>(input, output, config);
+
+            CHECK_EQ(read_file(output), expected);
+            CHECK_EQ(stats.records, data.size());
+            CHECK_EQ(stats.runs, 20);
+            CHECK_GT(stats.merge_passes, 1);
+            CHECK_LE(stats.bytes_read, (stats.merge_passes + 1) * data.size() * sizeof(T));
+            CHECK_EQ(stats.bytes_written, stats.bytes_read);
+            CHECK_GT(stats.write_calls, stats.runs);
+            CHECK_EQ(temp_files_left(), 0);
+        }
+    }
+
+    SUBCASE("Descending")
+    {
+        my::external_sort<T>(input, output, config, std::greater<T>{});
+        CHECK(std::equal(expected.crbegin(), expected.crend(), read_file(output).cbegin()));
+    }
+
+    SUBCASE("Single run")
+    {
+        config.memory_budget = data.size() * sizeof(T);
+        auto stats = my::external_sort<T>(input, output, config);
+        CHECK_EQ(read_file(output), expected);
+        CHECK_EQ(stats.runs, 1);
+        CHECK_EQ(stats.merge_passes, 0);
+
+        // Input size a multiple of the chunk size, with more than one chunk
+        config.memory_budget = data.size() / 2 * sizeof(T);
+        stats = my::external_sort<T>(input, output, config);
+        CHECK_EQ(read_file(output), expected);
+        CHECK_EQ(stats.runs, 2);
+        CHECK_EQ(stats.merge_passes, 1);
+    }
+
+    SUBCASE("Empty")
+    {
+        write_file(input, {});
+        const auto stats = my::external_sort<T>(input, output, config);
+        CHECK(read_file(output).empty());
+        CHECK_EQ(stats.records, 0);
+        CHECK_EQ(temp_files_left(), 0);
+    }
+
+    SUBCASE("Errors")
+    {
+        CHECK_THROWS_AS(my::external_sort<T>(directory / "missing", output, config), std::filesystem::filesystem_error);
+
+        std::ofstream(input, std::ios::binary | std::ios::app).put('x');
+        CHECK_THROWS_AS(my::external_sort<T>(input, output, config), std::filesystem::filesystem_error);
+        CHECK_EQ(temp_files_left(), 0);
+    }
+
+    fs::remove_all(directory);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <doctest/doctest.h>
+
+#include "include/integer_loader.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST_CASE_TEMPLATE("integer_loader.hpp", T, std::uint8_t, std::int32_t, std::uint32_t, std::int64_t, std::uint64_t)
+{
+    std::mt19937_64 gen(20);
+    std::vector<T> values(100000);
+    std::generate(values.begin(), values.end(), [&] {
+        // Every number of digits, up to the largest values
+        const auto digits = gen() % std::numeric_limits<T>::digits10 + 1;
+        auto value = static_cast<T>(gen() % static_cast<std::uint64_t>(std::pow(10.0, digits)));
+        return (std::is_signed<T>::value && gen() % 2) ? static_cast<T>(-value) : value;
+    });
+    values[0] = std::numeric_limits<T>::max();
+    values[1] = std::numeric_limits<T>::min();
+    values[2] = 0;
+
+    std::string text;
+    for (const auto value : values) {
+        text += std::to_string(+value) + '\n';
+    }
+
+    SUBCASE("parse_integers")
+    {
+        CHECK_EQ(my::parse_integers<T>(text), values);
+        CHECK(my::parse_integers<T>("").empty());
+        CHECK(my::parse_integers<T>(" \n\n").empty());
+
+        // Any non-digit separates numbers, and the text need not end with a line break
+        CHECK_EQ(my::parse_integers<T>("1 2,3\r\n04\t5"), std::vector<T>{1, 2, 3, 4, 5});
+        CHECK_EQ(my::parse_integers<T>("12345678,123456789 7"), std::vector<T>{T(12345678), T(123456789), 7});
+
+        if constexpr (std::is_signed<T>::value) {
+            CHECK_EQ(my::parse_integers<T>("-1 - 2 -0 3-4"), std::vector<T>{-1, 2, 0, 3, -4});
+        } else {
+            CHECK_EQ(my::parse_integers<T>("-1 - 2"), std::vector<T>{1, 2});
+        }
+    }
+
+    SUBCASE("parse_integers (parallel)")
+    {
+        // Chunks of 1 MiB at least: repeat the values so that the text spans several
+        std::string long_text;
+        std::vector<T> long_values;
+        while (long_text.size() < (std::size_t{5} << 20)) {
+            long_text += text;
+            long_values.insert(long_values.end(), values.cbegin(), values.cend());
+        }
+
+        const auto default_tasks = std::exchange(my::internal::AlgoConfig::PARALLEL_TASKS, 4);
+        CHECK_EQ(my::parse_integers<T>(std::execution::par, long_text), long_values);
+        CHECK_EQ(my::parse_integers<T>(std::execution::par, text), values);
+        CHECK_EQ(my::parse_integers<T>(std::execution::seq, text), values);
+        my::internal::AlgoConfig::PARALLEL_TASKS = default_tasks;
+    }
+
+    SUBCASE("load_integers")
+    {
+        const auto path = std::filesystem::temp_directory_path() / "my_integer_loader_test.txt";
+        std::ofstream(path, std::ios::binary) << text;
+
+        CHECK_EQ(my::load_integers<T>(path), values);
+        CHECK_EQ(my::load_integers<T>(std::execution::par, path), values);
+
+        std::ofstream(path, std::ios::binary | std::ios::trunc);
+        CHECK(my::load_integers<T>(path).empty());
+
+        std::filesystem::remove(path);
+        CHECK_THROWS_AS(my::load_integers<T>(path), std::filesystem::filesystem_error);
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <doctest/doctest.h>
+
+#include "include/radix_sort.hpp"
+
+#include <array>
+#include <deque>
+#include <vector>
+#include <random>
+#include <limits>
+
+TEST_CASE_TEMPLATE("radix_sort.hpp",
+                   T,
+                   std::uint8_t,
+                   std::uint16_t,
+                   std::uint32_t,
+                   std::int32_t,
+                   std::uint64_t,
+                   std::int64_t,
+                   float,
+                   double)
+{
+    std::mt19937_64 gen(1234);
+    const auto random_value = [&]() -> T {
+        if constexpr (std::is_floating_point<T>::value) {
+            return std::uniform_real_distribution<T>(-1e6, 1e6)(gen);
+        } else {
+            return static_cast<T>(gen());
+        }
+    };
+
+    std::vector<T> data(5000);
+    std::generate(data.begin(), data.end(), random_value);
+    data[0] = std::numeric_limits<T>::max();
+    data[1] = std::numeric_limits<T>::lowest();
+    data[2] = T{0};
+    data[3] = T{1};
+
+    std::vector<T> expected(data);
+    std::sort(expected.begin(), expected.end());
+
+    SUBCASE("lsd_radix_sort")
+    {
+        my::lsd_radix_sort(data.begin(), data.end());
+        CHECK(data == expected);
+
+        // Empty
+        std::vector<T> empty{};
+        my::lsd_radix_sort(empty.begin(), empty.end());
+        CHECK(empty.empty());
+    }
+
+    SUBCASE("msd_radix_sort")
+    {
+        my::msd_radix_sort(data.begin(), data.end());
+        CHECK(data == expected);
+
+        // Empty
+        std::vector<T> empty{};
+        my::msd_radix_sort(empty.begin(), empty.end());
+        CHECK(empty.empty());
+    }
+
+    SUBCASE("radix_sort")
+    {
+        // Few distinct keys
+        std::vector<T> few(1000);
+        std::generate(few.begin(), few.end(), [n = 0]() mutable { return static_cast<T>(n++ % 3); });
+        std::vector<T> few_expected(few);
+        std::sort(few_expected.begin(), few_expected.end());
+
+        my::radix_sort(few.begin(), few.end());
+        CHECK(few == few_expected);
+    }
+
+    SUBCASE("contiguous memory only")
+    {
+        static_assert(my::internal::is_contiguous_iterator<T*>::value);
+        static_assert(my::internal::is_contiguous_iterator<typename std::vector<T>::iterator>::value);
+        static_assert(my::internal::is_contiguous_iterator<typename std::array<T, 4>::iterator>::value);
+
+        // Random access, but split into chunks
+        static_assert(!my::internal::is_contiguous_iterator<typename std::deque<T>::iterator>::value);
+        // Sorting needs write access
+        static_assert(!my::internal::is_contiguous_iterator<const T*>::value);
+        static_assert(!my::internal::is_contiguous_iterator<typename std::vector<T>::const_iterator>::value);
+
+        std::array<T, 4> arr{T{3}, T{1}, T{2}, T{0}};
+        const std::array<T, 4> sorted{T{0}, T{1}, T{2}, T{3}};
+        my::radix_sort(arr.begin(), arr.end());
+        CHECK(arr == sorted);
+    }
+}
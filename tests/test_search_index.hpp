@@ -0,0 +1,57 @@
+#pragma once
+
+#include <doctest/doctest.h>
+
+#include "include/search_index.hpp"
+
+#include <vector>
+#include <random>
+#include <functional>
+
+TEST_CASE_TEMPLATE("search_index.hpp", T, int, double)
+{
+    SUBCASE("eytzinger_index")
+    {
+        std::mt19937 gen(14);
+        std::uniform_int_distribution<int> dist(0, 500);
+
+        // Sizes around powers of two exercise complete and incomplete last levels
+        for (const std::size_t size : {0, 1, 2, 3, 7, 8, 9, 100, 1023, 1024, 1025}) {
+            std::vector<T> sorted(size);
+            std::generate(sorted.begin(), sorted.end(), [&] { return static_cast<T>(dist(gen)); });
+            std::sort(sorted.begin(), sorted.end());
+
+            const my::eytzinger_index<T> index(sorted.cbegin(), sorted.cend());
+            CHECK_EQ(index.size(), size);
+
+            std::vector<T> keys;
+            for (int key = -1; key <= 502; ++key) {
+                keys.push_back(static_cast<T>(key));
+            }
+
+            std::vector<std::size_t> batched(keys.size());
+            auto out_end = index.lower_bound(keys.cbegin(), keys.cend(), batched.begin());
+            CHECK_EQ(out_end, batched.end());
+
+            for (std::size_t i = 0; i < keys.size(); ++i) {
+                const auto& key = keys[i];
+                const auto lower = std::lower_bound(sorted.cbegin(), sorted.cend(), key) - sorted.cbegin();
+                const auto upper = std::upper_bound(sorted.cbegin(), sorted.cend(), key) - sorted.cbegin();
+                CHECK_EQ(index.lower_bound(key), lower);
+                CHECK_EQ(index.upper_bound(key), upper);
+                CHECK_EQ(batched[i], lower);
+            }
+        }
+    }
+
+    SUBCASE("eytzinger_index (custom order)")
+    {
+        const std::vector<T> descending{9, 7, 7, 5, 3, 1};
+        const my::eytzinger_index<T, std::greater<T>> index(descending.cbegin(), descending.cend());
+
+        CHECK_EQ(index.lower_bound(T{7}), 1);
+        CHECK_EQ(index.upper_bound(T{7}), 3);
+        CHECK_EQ(index.lower_bound(T{0}), 6);
+        CHECK_EQ(index.partition_point([](const T& value) { return value > T{4}; }), 4);
+    }
+}